@@ -0,0 +1,214 @@
+/* ============================================================
+   Main routine of the headless batch program, which runs the model
+   simulation without the graphic display (no OpenGL/GLUT needed).
+   -----
+   Usage:
+      adapt-batch input.txt n_steps [output_every] [seed] [n_threads]
+                  [stats_file] [decimate]
+   -----
+      input.txt - text file of the initial conditions and the model
+                  parameters (same format as for adapt)
+      n_steps - number of time steps to simulate
+      output_every - number of time steps between outputs (default 10)
+      seed - seed of the random numbers (default 0: a random seed;
+             the same seed reproduces the same run)
+      n_threads - number of threads running the model simulation
+                  (default 1; 0 uses all cores; the results do not
+                  depend on it)
+      stats_file - file the statistics are written to instead of the
+                   terminal, as records of all fields of the statistics
+                   (CSV if the name ends with ".csv", otherwise binary;
+                   see Stats/StatsWriterC.hpp)
+      decimate - number of records after which the time between the
+                 records in $(stats_file) is doubled (default 0: never)
+   -----
+   Checkpoints (keys of input.txt):
+      checkpoint_file - file of the checkpoint of the run. If it exists,
+                 the run continues from it, with the parameters saved in
+                 it, up to $(n_steps) (bit-identically to a run that was
+                 never stopped); otherwise a new run starts. A checkpoint
+                 is written at the end of the run. The records of
+                 $(stats_file) are on the disk before every checkpoint,
+                 and those after the checkpoint are cut before the run
+                 continues, so the file has no gap and no duplicate.
+      checkpoint_every - number of time steps between checkpoints
+                 (default 0: only at the end)
+   Movies (keys of input.txt):
+      frame_prefix - start of the names of the image files of the
+                 frames (see Graphics/FrameWriterC.hpp)
+      frame_every - number of time steps between frames (default 0:
+                 no frames). The graphic layout is then updated every
+                 time step, as in the graphic program, and the frames
+                 are drawn and written by a background thread.
+   -----
+   Subroutines:
+      output_header - writes the names of the output columns.
+      output - writes the statistics of one time step as one line.
+      record - appends the statistics of one time step to the
+               stats file.
+      film - appends the frame of one time step to the movie.
+
+   Author: Yao-li Chuang
+   ============================================================ */
+#include "Main.H"
+#include "InitCond.H"
+#include "Parallel/ThreadPoolC.hpp"
+#include "Stats/StatsWriterC.hpp"
+#include "Graphics/FrameWriterC.hpp"
+
+/********************************************
+  Main routine 
+  -----
+  1. The initial conditions and the model parameters are read
+     from the input file and the model is initiated.
+     If the checkpoint file exists, the model is restored from it
+     instead.
+  2. The model runs up to the time step $(n_steps) in a loop, writing
+     the statistics to the terminal, or to $(stats_file), every
+     $(output_every) steps, and the checkpoints every
+     $(checkpoint_every) steps.
+ ********************************************/
+int main(int argc, char* argv[]) {
+  void output_header(void);
+  void output(nodeList *, long int);
+  void record(statsWriter *, nodeList *, long int);
+  void film(frameWriter *, nodeList *);
+
+  if(argc < 3) {
+    cout << "Usage: " << argv[0] << " input.txt n_steps [output_every] [seed] [n_threads] [stats_file] [decimate]" << endl;
+    return 1;
+  }
+  string file_name(argv[1]);
+  long int n_steps = atol(argv[2]);
+  long int output_every = (argc > 3) ? atol(argv[3]) : 10;
+  uint64_t seed = (argc > 4) ? strtoull(argv[4], NULL, 10) : 0;
+  int n_threads = (argc > 5) ? atoi(argv[5]) : 1;
+  long int decimate = (argc > 7) ? atol(argv[7]) : 0;
+  if(output_every <= 0) output_every = n_steps;
+
+  // Initiate the model
+  struct iniConditions initial_conditions = { 500, 50, 0.1, 5, 1.0, "", 0, "", 0 }; // default values
+  read_init_cond(file_name, initial_conditions);
+  string ckpt_name = initial_conditions.checkpoint_file;
+  long int ckpt_every = initial_conditions.checkpoint_every;
+  bool resumed = !ckpt_name.empty() && ifstream(ckpt_name.data()).good();
+  nodeList *nlist;
+  if(resumed) {
+    nlist = new nodeList(ckpt_name); // with the parameters of the checkpoint
+  } else {
+    nlist = create_node_list(initial_conditions, seed);
+    nlist->resetParametersFromFile(file_name);
+  }
+  long int t_start = resumed ? nlist->getTimeStep() : 0;
+  threadPool *pool = NULL;
+  if(n_threads != 1) {
+    pool = new threadPool(n_threads);
+    nlist->setThreadPool(pool);
+  }
+
+  // Run the model simulation
+  statsWriter *writer = NULL;
+  if(argc > 6) {
+    string stats_name(argv[6]);
+    bool is_csv = stats_name.size() >= 4
+      && stats_name.compare(stats_name.size()-4, 4, ".csv") == 0;
+    vector<string> columns = nodeList::getStatsNames();
+    columns.insert(columns.begin(), "time");
+    if(resumed) { // keep the records up to the checkpoint, as if never stopped
+      bool due = statsWriter::isDue(t_start, output_every, decimate)
+	|| t_start >= n_steps;
+      statsWriter::truncateAfter(stats_name, !is_csv, columns.size(),
+				 due ? t_start : t_start-1);
+    }
+    writer = new statsWriter(stats_name, columns, !is_csv, resumed);
+    writer->setCadence(output_every, decimate);
+    if(!resumed) record(writer, nlist, 0);
+  } else if(!resumed) {
+    output_header();
+    output(nlist, 0);
+  }
+  frameWriter *movie = NULL;
+  long int frame_every = initial_conditions.frame_every;
+  if(!initial_conditions.frame_prefix.empty() && frame_every > 0) {
+    movie = new frameWriter(initial_conditions.frame_prefix);
+    if(!resumed) film(movie, nlist);
+  }
+  for(long int t=t_start+1; t<=n_steps; t++) {
+    nlist->nextTimeStep();
+    if(writer != NULL) {
+      if(writer->isDue(t) || t == n_steps)
+	record(writer, nlist, t);
+    } else if(t%output_every == 0 || t == n_steps)
+      output(nlist, t);
+    if(movie != NULL) {
+      nlist->updateGraphData();
+      if(t%frame_every == 0) film(movie, nlist);
+    }
+    // The records up to the checkpoint are on the disk before it.
+    if(!ckpt_name.empty()
+       && ((ckpt_every > 0 && t%ckpt_every == 0) || t == n_steps)
+       && (writer == NULL || writer->sync()))
+      nlist->writeCheckpoint(ckpt_name);
+  }
+
+  if(writer != NULL) delete writer; // writing the remaining records
+  if(movie != NULL) delete movie;   // writing the remaining frames
+  delete nlist;
+  if(pool != NULL) delete pool;
+  return 0;
+}
+
+/******************************************************************
+  This subroutine writes the names of the columns written by output.
+ ******************************************************************/
+void output_header(void) {
+  cout << "#time\t";
+  nodeList::writeStatsHeader(cout);
+  cout << '\n';
+}
+
+/******************************************************************
+  This subroutine writes the statistical results of one time step
+    to the terminal as one line of tab-separated columns.
+  Input ---
+     nlist: the list of nodes
+     t: the current time
+ ******************************************************************/
+void output(nodeList *nlist, long int t) {
+
+  // Update the statistics
+  nlist->computeStats();
+
+  cout << t << '\t';
+  nlist->writeStats(cout);
+  cout << '\n';
+}
+
+/******************************************************************
+  This subroutine appends the statistics of one time step to the
+    stats file as one record: the time and all fields of the
+    statistics (see getStatsValues in Stats/StatC.cxx).
+  Input ---
+     writer: the writer of the stats file
+     nlist: the list of nodes
+     t: the current time
+ ******************************************************************/
+void record(statsWriter *writer, nodeList *nlist, long int t) {
+  nlist->computeStats();
+  vector<double> values(1, static_cast<double>(t));
+  nlist->getStatsValues(values);
+  writer->append(values.data());
+}
+
+/******************************************************************
+  This subroutine appends the current picture of the model, as the
+    graphic program shows it, to the movie as one frame.
+  Input ---
+     movie: the writer of the frames
+     nlist: the list of nodes
+ ******************************************************************/
+void film(frameWriter *movie, nodeList *nlist) {
+  static graphSnapshot snap; // keeps its memory between the frames
+  nlist->writeSnapshot(snap);
+  movie->append(snap);
+}
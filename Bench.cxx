@@ -0,0 +1,179 @@
+/* ============================================================
+   Main routine of the benchmark program, which times the phases
+   of a time step of the model simulation (and of the graphic and
+   the statistical computations) over a grid of population sizes,
+   guest ratios, and initial connections.
+   -----
+   Usage:
+      adapt-bench [output_file] [n_repeat] [max_n] [n_threads]
+   -----
+      output_file - the results are written to this file as JSON
+                    (default bench.json)
+      n_repeat - number of times each phase is timed (default 10)
+      max_n - largest population size of the grid (default 100000)
+      n_threads - number of threads running the model simulation
+                  (default 1; 0 uses all cores)
+   -----
+   The grid is n_node = 500, 2000, 10000, 50000, 100000 (up to max_n),
+      guest_ratio = 0.1, 0.3, and initial_connections = 5, 10, with the
+      default parameters and the seed 1 at every point, so the runs
+      are the same from one benchmark to the next.
+   At every grid point, the list of nodes is made and run for 10 time
+      steps; the phases are then timed in the order of a time step,
+      $(n_repeat) times, with the model evolving in between. The
+      phase that needs O(n^2) memory, updateDistMatrix, is timed only for small
+      populations (see phase_limit).
+   For every phase, the median and the 95th percentile (nearest rank)
+      of the times are written, in milliseconds, e.g.,
+      {"n_node": 500, "guest_ratio": 0.1, "initial_connections": 5,
+       "seed": 1, "phases": {"createAdjMatrix": {"median_ms": 0.05,
+       "p95_ms": 0.06}, ...}}
+   -----
+   Subroutines:
+      phaseBench::run - runs one phase of a list of nodes.
+      phase_limit - returns the largest population a phase is timed for.
+      percentile - returns a percentile of a list of times.
+
+   Author: Yao-li Chuang
+   ============================================================ */
+#include "Main.H"
+#include "Node/NodeListC.hpp"
+#include "Parallel/ThreadPoolC.hpp"
+#include <chrono>
+
+// The phases timed, in the order of a time step
+const char *phase_names[] = {"createAdjMatrix", "createUtMatrix",
+			     "updateOpinion", "updateOpinion2",
+			     "updateUtMatrix", "evolveAdjMatrix",
+			     "updateConnection", "updateGraphData",
+			     "updateDistMatrix", "numCluster"};
+const int n_phase = sizeof(phase_names)/sizeof(phase_names[0]);
+
+/**************************************************************
+  The phases of a list of nodes, run by their names
+  (a friend of nodeList, to reach the private phases)
+ **************************************************************/
+class phaseBench {
+public:
+  static void run(nodeList *nlist, string phase);
+};
+
+/********************************************
+  Main routine 
+ ********************************************/
+int main(int argc, char* argv[]) {
+  long int phase_limit(string);
+  double percentile(vector<double>, double);
+
+  string file_name = (argc > 1) ? argv[1] : "bench.json";
+  int n_repeat = (argc > 2) ? atoi(argv[2]) : 10;
+  int max_n = (argc > 3) ? atoi(argv[3]) : 100000;
+  int n_threads = (argc > 4) ? atoi(argv[4]) : 1;
+  if(n_repeat < 1) n_repeat = 1;
+  threadPool *pool = (n_threads != 1) ? new threadPool(n_threads) : NULL;
+  ofstream out(file_name.data());
+  if(!out.is_open()) {
+    cout << "Error in adapt-bench: unable to open " << file_name << endl;
+    return 1;
+  }
+
+  int sizes[] = {500, 2000, 10000, 50000, 100000};
+  double ratios[] = {0.1, 0.3};
+  int connections[] = {5, 10};
+  const uint64_t seed = 1;
+  out << "{\"repeats\": " << n_repeat << ", \"threads\": "
+      << ((pool != NULL) ? pool->getNumThreads() : 1) << ", \"results\": [";
+  bool first_point = true;
+  for(int s=0; s<5 && sizes[s]<=max_n; s++)
+    for(int r=0; r<2; r++)
+      for(int c=0; c<2; c++) {
+	int n = sizes[s];
+	cout << "n_node " << n << ", guest_ratio " << ratios[r]
+	     << ", initial_connections " << connections[c] << endl;
+	nodeList *nlist = new nodeList(n, ratios[r], connections[c], 1.0, seed);
+	nlist->setThreadPool(pool);
+	for(int t=0; t<10; t++)
+	  nlist->nextTimeStep();
+
+	// Time the phases.
+	vector<vector<double> > times(n_phase);
+	for(int k=0; k<n_repeat; k++)
+	  for(int p=0; p<n_phase; p++) {
+	    if(n > phase_limit(phase_names[p])) continue;
+	    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	    phaseBench::run(nlist, phase_names[p]);
+	    chrono::duration<double, milli> spent = chrono::steady_clock::now() - start;
+	    times[p].push_back(spent.count());
+	  } // end of k,p loop
+
+	// Write the results of this grid point.
+	out << (first_point ? "\n" : ",\n") << "  {\"n_node\": " << n
+	    << ", \"guest_ratio\": " << ratios[r]
+	    << ", \"initial_connections\": " << connections[c]
+	    << ", \"seed\": " << seed << ", \"phases\": {";
+	first_point = false;
+	bool first_phase = true;
+	for(int p=0; p<n_phase; p++) {
+	  if(times[p].empty()) continue;
+	  out << (first_phase ? "" : ",") << "\n    \"" << phase_names[p]
+	      << "\": {\"median_ms\": " << percentile(times[p], 50.0)
+	      << ", \"p95_ms\": " << percentile(times[p], 95.0) << "}";
+	  first_phase = false;
+	} // end of p loop
+	out << "}}";
+	out.flush();
+	delete nlist;
+      } // end of s,r,c loop
+  out << "\n]}\n";
+  out.close();
+  if(pool != NULL) delete pool;
+  return 0;
+}
+
+/******************************************************************
+  This subroutine runs the phase $(phase) of the list $(nlist) once.
+  The opinion updates start a new time step, as nextTimeStep does,
+    so that they draw new random numbers.
+ ******************************************************************/
+void phaseBench::run(nodeList *nlist, string phase) {
+  if(phase == "createAdjMatrix") nlist->createAdjMatrix();
+  else if(phase == "createUtMatrix") nlist->createUtMatrix();
+  else if(phase == "updateOpinion") {
+    nlist->time_step++;
+    nlist->updateOpinion();
+  } else if(phase == "updateOpinion2") {
+    nlist->time_step++;
+    nlist->updateOpinion2();
+  } else if(phase == "updateUtMatrix") nlist->updateUtMatrix();
+  else if(phase == "evolveAdjMatrix") nlist->evolveAdjMatrix();
+  else if(phase == "updateConnection") nlist->updateConnection();
+  else if(phase == "updateGraphData") nlist->updateGraphData();
+  else if(phase == "updateDistMatrix") nlist->updateDistMatrix();
+  else if(phase == "numCluster") nlist->numCluster();
+  else {
+    cout << "Error in phaseBench: no phase called " << phase << endl;
+    exit(1);
+  }
+}
+
+/******************************************************************
+  This function returns the largest population for which the phase
+    $(phase) is timed: the distances between all pairs of nodes take
+    O(n^2) memory and O(n * links) time.
+ ******************************************************************/
+long int phase_limit(string phase) {
+  if(phase == "updateDistMatrix") return 5000;
+  return LONG_MAX;
+}
+
+/******************************************************************
+  This function returns the percentile $(pct) of the times $(t),
+    by the nearest rank, i.e., the smallest time that is not less
+    than pct percent of the times.
+ ******************************************************************/
+double percentile(vector<double> t, double pct) {
+  sort(t.begin(), t.end());
+  int rank = static_cast<int>(ceil(pct/100.0*t.size()));
+  if(rank < 1) rank = 1;
+  return t[rank-1];
+}
@@ -37,18 +37,18 @@ agent::agent(double r, double theta) {
   Inputs --
      cxy : (x, y) coordinates of the center of the circle
      r : radius of the circle
+     u_r, u_th : two uniform random numbers in [0, 1), which set
+                 the distance from the center and the angle
  ************************************************************************/
-agent::agent(vector<double> cxy, double r) {
+agent::agent(vector<double> cxy, double r, double u_r, double u_th) {
   //Assign an initial position on a ring of R=100 with an angle theta.
   //Setting initial velocity and Force to zero.
   if(!pos.empty()) pos.clear();
   if(!vel.empty()) vel.clear();
   if(!force.empty()) force.clear();
 
-  double tmp_r = r*sqrt( static_cast<double>(rand())
-			 /static_cast<double>(RAND_MAX) );
-  double tmp_th = M_PI*2.0*( static_cast<double>(rand())
-				    /static_cast<double>(RAND_MAX) );
+  double tmp_r = r*sqrt(u_r);
+  double tmp_th = M_PI*2.0*u_th;
 
   double tmpx = tmp_r*cos(tmp_th);
   double tmpy = tmp_r*sin(tmp_th);
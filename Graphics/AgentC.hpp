@@ -27,15 +27,18 @@ public:
   // Constructors and destructor
   agent(void) { pos.clear(); vel.clear(); force.clear(); }
   agent(double r, double theta);
-  agent(vector<double> cxy, double r);
+  agent(vector<double> cxy, double r, double u_r, double u_th);
   ~agent(void) { pos.clear(); vel.clear(); force.clear(); }
-  // Getters and setters
-  vector<double> getPos(void) {return pos;}
+  // Getters (read-only references, no copies) and setters
+  const vector<double> &getPos(void) const {return pos;}
   void setPos(vector<double> value) {pos = value;}
-  vector<double> getVel(void) {return vel;}
+  void setPos(double x, double y) {pos.resize(2); pos[0] = x; pos[1] = y;}
+  const vector<double> &getVel(void) const {return vel;}
   void setVel(vector<double> value) {vel = value;}
-  vector<double> getForce(void) {return force;}
+  const vector<double> &getForce(void) const {return force;}
   void setForce(vector<double> value) {force = value;}
+  void setForce(double fx, double fy)
+    {force.resize(2); force[0] = fx; force[1] = fy;}
 
 private:
   vector<double> pos, vel, force;
@@ -0,0 +1,166 @@
+/* ============================================================
+   Source codes for the frameWriter class
+            the constructor and the destructor
+            void append
+            void rasterize
+            void writerLoop
+            void writeFrame
+
+   Author: Yao-li Chuang
+   ============================================================ */
+#include"FrameWriterC.hpp"
+#include<cstdio>
+
+/************************************************************************
+  Constructor of a frame writer, which starts the background thread.
+  Inputs:
+     file_prefix - start of the names of the image files
+     image_width, image_height - size of the images in pixels
+*************************************************************************/
+frameWriter::frameWriter(string file_prefix, int image_width,
+			 int image_height)
+  : prefix(file_prefix), width(image_width), height(image_height),
+    stopping(false) {
+  writer = thread(&frameWriter::writerLoop, this);
+}
+
+/************************************************************************
+  Destructor: the frames appended are all written before it returns.
+*************************************************************************/
+frameWriter::~frameWriter(void) {
+  {
+    lock_guard<mutex> guard(lock);
+    stopping = true;
+  }
+  wake.notify_one();
+  writer.join();
+}
+
+/************************************************************************
+  This subroutine appends a copy of the snapshot $(snap) as the next
+    frame; it waits only if $(max_pending) frames are waiting already.
+*************************************************************************/
+void frameWriter::append(const graphSnapshot &snap) {
+  unique_lock<mutex> guard(lock);
+  drained.wait(guard, [this]() { return pending.size() < max_pending; });
+  pending.push_back(snap);
+  wake.notify_one();
+}
+
+/************************************************************************
+  This subroutine draws the snapshot $(snap) into an image of $(w) x $(h)
+    pixels, as RendererC.cxx draws it with OpenGL.
+  Output value:
+     $(rgb) receives 3 bytes (red, green, blue) per pixel, row by row
+        from the top of the image.
+  -----
+  The window coordinates are those of OpenGL: the model coordinate x
+    in [-200, 200] maps to [0, w), and the pixel (i, j) from the bottom
+    left covers [i, i+1) x [j, j+1). The lines are drawn by steps of
+    at most 1 pixel along their longer axis after clipping them to the
+    image (Liang-Barsky); the edges of the points are smoothed by their
+    coverage of each pixel, as with GL_POINT_SMOOTH.
+*************************************************************************/
+void frameWriter::rasterize(const graphSnapshot &snap, int w, int h,
+			    vector<unsigned char> &rgb) {
+  rgb.assign(3*static_cast<size_t>(w)*h, 255); // white background
+  double sx = w/400.0, sy = h/400.0;
+  const vector<float> &pos = snap.pos;
+
+  // Draw the links as gray lines.
+  for(size_t l=0; 2*l<snap.links.size(); l++) {
+    int i = snap.links[2*l], j = snap.links[2*l+1];
+    double x0 = (pos[2*i]+200.0)*sx, y0 = (pos[2*i+1]+200.0)*sy;
+    double dx = (pos[2*j]+200.0)*sx - x0, dy = (pos[2*j+1]+200.0)*sy - y0;
+    if(!isfinite(x0) || !isfinite(y0) || !isfinite(dx) || !isfinite(dy))
+      continue;
+    double t0 = 0.0, t1 = 1.0; // the part of the line inside the image
+    double p[4] = {-dx, dx, -dy, dy}, q[4] = {x0, w-x0, y0, h-y0};
+    bool inside = true;
+    for(int k=0; k<4 && inside; k++) {
+      if(p[k] == 0.0) inside = (q[k] >= 0.0);
+      else if(p[k] < 0.0) t0 = max(t0, q[k]/p[k]);
+      else t1 = min(t1, q[k]/p[k]);
+    } // end of k loop
+    if(!inside || t0 > t1) continue;
+    int n_step = static_cast<int>(ceil(max(fabs(dx), fabs(dy))*(t1-t0)));
+    for(int s=0; s<=n_step; s++) {
+      double t = (n_step == 0) ? t0 : t0 + (t1-t0)*s/n_step;
+      int px = static_cast<int>(floor(x0 + dx*t));
+      int py = static_cast<int>(floor(y0 + dy*t));
+      if(px < 0 || px >= w || py < 0 || py >= h) continue;
+      unsigned char *c = &rgb[3*(static_cast<size_t>(h-1-py)*w + px)];
+      c[0] = c[1] = c[2] = 77; // 0.3 of full intensity
+    } // end of s loop
+  } // end of l loop
+
+  // Draw the nodes as round points over the lines.
+  double size = 4.2*w/400.0; // the diameter in pixels
+  double r = 0.5*(size > 2.0 ? size : 2.0);
+  int n = snap.opinion.size();
+  for(int i=0; i<n; i++) {
+    double cx = (pos[2*i]+200.0)*sx, cy = (pos[2*i+1]+200.0)*sy;
+    if(!isfinite(cx) || !isfinite(cy)
+       || cx < -r || cx > w+r || cy < -r || cy > h+r) continue;
+    double c = snap.opinion[i], color[3];
+    if(c > 0.0) { // from white (0) to blue (1)
+      color[0] = 1.0-c; color[1] = 1.0-c; color[2] = 1.0;
+    } else {      // from white (0) to red (-1)
+      color[0] = 1.0; color[1] = 1.0+c; color[2] = 1.0+c;
+    }
+    int px0 = max(static_cast<int>(floor(cx-r)), 0);
+    int px1 = min(static_cast<int>(floor(cx+r)), w-1);
+    int py0 = max(static_cast<int>(floor(cy-r)), 0);
+    int py1 = min(static_cast<int>(floor(cy+r)), h-1);
+    for(int py=py0; py<=py1; py++)
+      for(int px=px0; px<=px1; px++) {
+	double d = sqrt((px+0.5-cx)*(px+0.5-cx) + (py+0.5-cy)*(py+0.5-cy));
+	double a = r + 0.5 - d; // coverage of the pixel
+	if(a <= 0.0) continue;
+	if(a > 1.0) a = 1.0;
+	unsigned char *p = &rgb[3*(static_cast<size_t>(h-1-py)*w + px)];
+	for(int k=0; k<3; k++)
+	  p[k] = static_cast<unsigned char>(a*255.0*color[k] + (1.0-a)*p[k] + 0.5);
+      } // end of py,px loop
+  } // end of i loop
+}
+
+/************************************************************************
+  The loop of the background thread, which draws and writes the frames
+    in order until the writer is stopping and nothing is left.
+*************************************************************************/
+void frameWriter::writerLoop(void) {
+  for(;;) {
+    graphSnapshot snap;
+    {
+      unique_lock<mutex> guard(lock);
+      wake.wait(guard, [this]() { return stopping || !pending.empty(); });
+      if(pending.empty()) return; // stopping
+      swap(snap, pending.front());
+      pending.pop_front();
+    }
+    drained.notify_one();
+    writeFrame(snap);
+  } // end of for loop
+}
+
+/************************************************************************
+  This subroutine draws the snapshot $(snap) and writes it to the PPM
+    file of its time step.
+*************************************************************************/
+void frameWriter::writeFrame(const graphSnapshot &snap) {
+  vector<unsigned char> rgb;
+  rasterize(snap, width, height, rgb);
+  char name_end[32];
+  snprintf(name_end, sizeof(name_end), "_%08ld.ppm", snap.time);
+  string file_name = prefix + name_end;
+  FILE *file = fopen(file_name.data(), "wb");
+  if(file == NULL) {
+    cout << "Error in frameWriter: unable to open " << file_name << endl;
+    return;
+  }
+  fprintf(file, "P6\n%d %d\n255\n", width, height);
+  if(fwrite(rgb.data(), 1, rgb.size(), file) != rgb.size())
+    cout << "Error in frameWriter: unable to write " << file_name << endl;
+  fclose(file);
+}
@@ -0,0 +1,76 @@
+/* ============================================================
+   Header file for the frameWriter class
+   -----
+   Brief Summary: A sink of the frames of a movie, which draws
+                  snapshots of the model (see SnapshotC.hpp) with
+                  a software rasterizer and writes them as image
+                  files through a background thread, with no
+                  graphic library or display.
+   -----
+      variables --
+          prefix : start of the names of the image files; the frame
+                   of time step t is written to prefix_<t>.ppm, with
+                   t in 8 digits
+          width, height : size of the images in pixels
+          pending : snapshots waiting to be drawn and written
+          stopping : flag of the destructor to the background thread
+          writer : the background thread drawing and writing
+                   $(pending)
+   -----
+      The frames show the same scene as display in Main.cxx (see
+        RendererC.cxx): the square [-200, 200] x [-200, 200] of the
+        model coordinates on a white background, the links as gray
+        lines of 1 pixel, and the nodes over them as round points
+        colored by their opinions.
+      The images are binary PPM files (P6), which most movie
+        encoders read, e.g.,
+           ffmpeg -pattern_type glob -i 'prefix_*.ppm' movie.mp4
+      The simulation only copies the snapshot; it waits only when
+        $(max_pending) frames are waiting already, so that a slow
+        disk cannot fill the memory.
+   -----
+       Functions and subroutines not defined explicitly here are
+          defined in FrameWriterC.cxx.
+
+   Author: Yao-li Chuang
+   ============================================================ */
+#ifndef __FrameWriterC_hpp_INCLUDED__
+#define __FrameWriterC_hpp_INCLUDED__
+
+#include"../CCommon.h"
+#include"SnapshotC.hpp"
+#include<deque>
+#include<thread>
+#include<mutex>
+#include<condition_variable>
+
+/**************************************************************
+   frameWriter class
+ **************************************************************/
+class frameWriter {
+
+public:
+  // Constructor & destructor
+  frameWriter(string file_prefix, int image_width=750, int image_height=750);
+  ~frameWriter(void); // writes the frames still pending
+  // Appending frames
+  void append(const graphSnapshot &snap);
+  // Drawing a snapshot into $(rgb) (3 bytes per pixel, top row first)
+  static void rasterize(const graphSnapshot &snap, int w, int h,
+			vector<unsigned char> &rgb);
+
+private:
+  static const size_t max_pending = 8;
+  string prefix;
+  int width, height;
+  deque<graphSnapshot> pending;
+  bool stopping;
+  mutex lock;
+  condition_variable wake, drained;
+  thread writer;
+  void writerLoop(void);
+  void writeFrame(const graphSnapshot &snap);
+};
+
+
+#endif
@@ -5,134 +5,193 @@
      by a graphic agent. (The agent data class is defined
      in agentC.hpp.)
 	    void updateGraphData
-	    void createForceMatrix
-	    void updateForceMatrix
+	    void writeSnapshot
+	    void updateForces
 	    void updatePosition
-	    vector<double> forceFunction
-	    vector<double> repulsionFunction
+	    void forceFunction
+	    void repulsionFunction
+   -----
+    Note:
+       Each agent feels the spring forces of its linked partners
+          and the repulsion of the unlinked agents within the
+          distance $(repulsion_range). The springs are summed over
+          the adjacency lists, and the repulsion over the agents
+          in the 3x3 cells around the agent in a uniform grid of
+          cells no smaller than repulsion_range, so a step of the
+          layout takes O(n + number of links) rather than O(n^2).
+          A cell crowded with more than $(cell_sample) agents repels
+          by a sample of every stride-th of its agents, each weighted
+          by the stride, so the work per agent stays bounded however
+          densely the agents crowd.
+       The forces on each agent are summed by the agent itself
+          (computing the force of each pair at both ends), so the
+          agents are split among the threads of $(pool) and the
+          positions do not depend on the number of threads.
 
    Author: Yao-li Chuang
    ============================================================ */
 #include"../Node/NodeListC.hpp"
+#include"SnapshotC.hpp"
+
+static const double repulsion_range = 30.0; // see repulsionFunction
+static const int cell_sample = 64; // most agents of a cell taken one by one
 
 /*****************************************************************
-  This subroutine update the positions of the graphic agents.
-  The force matrix is created and updated for the computation 
-     and then cleared at the end.
+  This subroutine updates the positions of the graphic agents
+     by one step of the forces between them.
 *****************************************************************/
 void nodeList::updateGraphData(void) {
-  createForceMatrix();
-  updateForceMatrix();
-  updatePosition();
-  forceMatrix.clear();
+  int n=opinion.size();
+  vector<double> pos(2*n), force(2*n, 0.0);
+  for(int i=0; i<n; i++) {
+    const vector<double> &posi = agents[i].getPos();
+    pos[2*i] = posi.at(0);
+    pos[2*i+1] = posi.at(1);
+  }
+  updateForces(pos, force);
+  updatePosition(pos, force);
 }
 
 /*****************************************************************
-   This subroutine creates the force matrix and fills it with 0.
+  This subroutine copies what the display draws into $(snap):
+    the positions of the agents, the opinions, and the links,
+    each listed once from its lower end.
+  The vectors of the snapshot keep their memory from one call to
+    the next.
 *****************************************************************/
-void nodeList::createForceMatrix(void) {
-  int n=memberNodes.size();
-  int m=2*n*n;
-  if(!forceMatrix.empty()) forceMatrix.clear();
-  forceMatrix.assign(m, 0.0);
+void nodeList::writeSnapshot(graphSnapshot &snap) {
+  int n=opinion.size();
+  snap.time = time_step;
+  snap.pos.resize(2*n);
+  snap.opinion.resize(n);
+  snap.links.clear();
+  for(int i=0; i<n; i++) {
+    const vector<double> &posi = agents[i].getPos();
+    snap.pos[2*i] = posi.at(0);
+    snap.pos[2*i+1] = posi.at(1);
+    snap.opinion[i] = opinion[i];
+    for(size_t k=0; k<adjList[i].size(); k++)
+      if(adjList[i][k] > i) {
+	snap.links.push_back(i);
+	snap.links.push_back(adjList[i][k]);
+      }
+  } // end of i loop
 }
 
 /*****************************************************************
-   This subroutine fills the elements of the force matrix.
-       forceMatrix[i][j][k]: the k-th component of the force 
-                             on agent(node) i, caused by agent(node) j
+   This subroutine computes the total force on each agent.
+   Input values:
+      $(pos) holds the (x, y) positions of the agents.
+      $(force) receives the (x, y) components of the force on
+         each agent (2 entries per agent, as $(pos)).
+   -----
+   The agents are sorted into the cells of the grid by a counting
+     sort: the agents of cell c are cell_node[cell_start[c]] to
+     cell_node[cell_start[c+1]-1]. The cells are enlarged, if
+     needed, so that there are no more than about 4 cells per
+     agent however far the agents spread.
+   The agents of a cell of more than $(cell_sample) agents are taken
+     with a stride of ceil(count/cell_sample), starting from the
+     (i % stride)-th one so that the agents nearby sample different
+     members of the cell, and their forces are multiplied by the
+     stride; a cell of no more than $(cell_sample) agents is taken
+     whole, exactly as before.
+   The partners of an agent are marked in an array of flags kept
+     by each thread from one call to the next, and unmarked when
+     the agent is done, so the flags are all clear between agents.
 *****************************************************************/
-void nodeList::updateForceMatrix(void) {
-  int n=memberNodes.size();
-  int m=2*n*n;
-  if(forceMatrix.size()!=m) createForceMatrix();
-
+void nodeList::updateForces(const vector<double> &pos, vector<double> &force) {
+  int n=opinion.size();
+  if(n == 0) return;
+  double xmin=INFINITY, xmax=-INFINITY, ymin=INFINITY, ymax=-INFINITY;
+  for(int i=0; i<n; i++) {
+    double px = pos[2*i], py = pos[2*i+1];
+    if(!isfinite(px) || !isfinite(py)) continue;
+    xmin = min(xmin, px); xmax = max(xmax, px);
+    ymin = min(ymin, py); ymax = max(ymax, py);
+  } // end of i loop
+  if(xmin > xmax) xmin = xmax = ymin = ymax = 0.0; // no finite position
+  double cell = repulsion_range;
+  long int nx, ny;
+  for(;;) {
+    nx = static_cast<long int>((xmax-xmin)/cell) + 1;
+    ny = static_cast<long int>((ymax-ymin)/cell) + 1;
+    if(nx*ny <= 4*static_cast<long int>(n) + 16) break;
+    cell *= 2.0;
+  } // end of for loop
+  // the cell of each agent (agents with no finite position in cell 0)
+  vector<int> cx(n, 0), cy(n, 0);
+  vector<int> cell_start(nx*ny+1, 0), cell_node(n);
+  for(int i=0; i<n; i++) {
+    double px = pos[2*i], py = pos[2*i+1];
+    if(isfinite(px) && isfinite(py)) {
+      cx[i] = min(static_cast<long int>((px-xmin)/cell), nx-1);
+      cy[i] = min(static_cast<long int>((py-ymin)/cell), ny-1);
+    }
+    cell_start[cy[i]*nx + cx[i] + 1]++;
+  } // end of i loop
+  for(long int c=0; c<nx*ny; c++)
+    cell_start[c+1] += cell_start[c];
+  vector<int> fill(cell_start.begin(), cell_start.end()-1);
   for(int i=0; i<n; i++)
-    for(int j=i+1; j<n; j++) {
-      int ij = i*n + j;
-      int ji = j*n + i;
-      // Compute the force between nodes i and j. 
-      // For connected nodes i and j, they are linked by an elastic force.
-      // For unconnected nodes, there is a repulsive force between them.
-      if(adjMatrix.at(ij)==1) { // elastic force for connected nodes
-	if(adjMatrix.at(ji) != 1) { // For undirectional edges, the adjacency Matrix should be symmetric.
-	  cout << "Error: adjMatrix is not symmetric in updateForceMatrix" << endl;
-	  exit(1);
-	}
-	agent ai=memberNodes[i].getGraphAgent(),
-	  aj=memberNodes[j].getGraphAgent(); // graphic agents for nodes i,j
-	vector<double> ftmp = forceFunction( memberNodes[i].getNodeType(),
-					     memberNodes[i].getOpinion(),
-					     ai.getPos(),
-					     memberNodes[j].getNodeType(),
-					     memberNodes[j].getOpinion(),
-					     aj.getPos() ); // computing the force on node i, caused by node j
-	forceMatrix.at(ij*2) = ftmp[0]; // force on i by j
-	forceMatrix.at(ij*2+1) = ftmp[1];
-	forceMatrix.at(ji*2) = -ftmp[0]; // force on j by i is the opposite vector
-	forceMatrix.at(ji*2+1) = -ftmp[1];
-      } else { // repulsive force for unconnected nodes
-	agent ai=memberNodes[i].getGraphAgent(),
-	  aj=memberNodes[j].getGraphAgent();
-	vector<double> ftmp = repulsionFunction( memberNodes[i].getNodeType(),
-						 memberNodes[i].getOpinion(),
-						 ai.getPos(),
-						 memberNodes[j].getNodeType(),
-						 memberNodes[j].getOpinion(),
-						 aj.getPos() );
-	forceMatrix.at(ij*2) = ftmp[0];
-	forceMatrix.at(ij*2+1) = ftmp[1];
-	forceMatrix.at(ji*2) = -ftmp[0];
-	forceMatrix.at(ji*2+1) = -ftmp[1];
-	/*
-	// In case we do not need the repulsive force.
-	forceMatrix.at(ij*2) = 0.0;
-	forceMatrix.at(ij*2+1) = 0.0;
-	forceMatrix.at(ji*2) = 0.0;
-	forceMatrix.at(ji*2+1) = 0.0;
-	*/
-      } // end of if (adjMatrix element == 1) statement
-    } // end of i,j loop
+    cell_node[fill[cy[i]*nx + cx[i]]++] = i;
+
+  forEachNodeRange([&](int first, int last) {
+    static thread_local vector<char> linked; // linked[j]: j is linked with i
+    if(linked.size() < static_cast<size_t>(n)) linked.resize(n, 0);
+    double f[2];
+    for(int i=first; i<last; i++) {
+      const double *pi = &pos[2*i];
+      double fx = 0.0, fy = 0.0;
+      // elastic forces of the linked partners
+      for(int k=0; k<num_link[i]; k++) {
+	int j = adjList[i][k];
+	linked[j] = 1;
+	forceFunction(node_type[i], opinion[i], pi,
+		      node_type[j], opinion[j], &pos[2*j], f);
+	fx += f[0]; fy += f[1];
+      } // end of k loop
+      // repulsive forces of the unlinked agents nearby
+      for(long int y=max(cy[i]-1, 0); y<=min(cy[i]+1L, ny-1); y++)
+	for(long int x=max(cx[i]-1, 0); x<=min(cx[i]+1L, nx-1); x++) {
+	  long int c = y*nx + x;
+	  int count = cell_start[c+1] - cell_start[c];
+	  if(count == 0) continue;
+	  int stride = (count + cell_sample - 1)/cell_sample; // 1 unless crowded
+	  for(int s=cell_start[c] + i%stride; s<cell_start[c+1]; s+=stride) {
+	    int j = cell_node[s];
+	    const double *pj = &pos[2*j];
+	    if(j == i || fabs(pj[0]-pi[0]) > repulsion_range
+	       || fabs(pj[1]-pi[1]) > repulsion_range || linked[j])
+	      continue;
+	    repulsionFunction(node_type[i], opinion[i], pi,
+			      node_type[j], opinion[j], pj, f);
+	    fx += stride*f[0]; fy += stride*f[1];
+	  } // end of s loop
+	} // end of y,x loop
+      for(int k=0; k<num_link[i]; k++)
+	linked[adjList[i][k]] = 0;
+      force[2*i] = fx;
+      force[2*i+1] = fy;
+    } // end of i loop
+  }); // end of forEachNodeRange
 }
 
 /*****************************************************************
-   This subroutine updates the positions of the agents according to
-     the force defined in forceMatrix.
+   This subroutine moves the agents by the forces computed by
+     updateForces, and keeps the forces in the agents.
 *****************************************************************/
-void nodeList::updatePosition(void) {
-  int n=memberNodes.size();
-  int m=n*n*2;
-  if(forceMatrix.size() != m) createForceMatrix();
-
-  // Save the positions at time t
-  vector<double> pos_old; 
+void nodeList::updatePosition(const vector<double> &pos,
+			      const vector<double> &force) {
+  int n=opinion.size();
   for(int i=0; i<n; i++) {
-    vector<double> posi = memberNodes[i].getGraphAgent().getPos();
-    pos_old.push_back(posi.at(0));
-    pos_old.push_back(posi.at(1));
-  }
-  // Update the positions to time t+1
-  for(int i=0; i<n; i++) {
-    //if(num_link.at(i)!=0) {
-      vector<double> tforce(2, 0.0);
-      for(int j=0; j<n; j++) {
-	//if(adjMatrix[i*n + j]==0) continue;
-	int ij2 = (i*n+j)*2;
-	for(int k=0; k<2; k++)
-	  tforce.at(k) += forceMatrix[ij2+k];
-      } // end of j loop
-      vector<double> pos_new(2, 0.0);
-      for(int k=0; k<2; k++)
-	pos_new.at(k) = pos_old.at(2*i+k) + tforce.at(k);
-      agent tmp_agent;
-      tmp_agent.setPos(pos_new);
-      tmp_agent.setForce(tforce);
-      memberNodes[i].setGraphAgent(tmp_agent);
-    } // end of i loop and if num_link[i] not zero
+    agents[i].setPos(pos[2*i] + force[2*i], pos[2*i+1] + force[2*i+1]);
+    agents[i].setForce(force[2*i], force[2*i+1]);
+  } // end of i loop
 }
 
 /************************************************************************
-  This function computes a "force" between 2 graphic agents of linked nodes.
+  This subroutine computes a "force" between 2 graphic agents of linked nodes.
   Here we adopt the Hooke's law F = k(p1-p2)^2, and model the pseudo-force
      as a spring.
   Inputs --
@@ -142,40 +201,36 @@ void nodeList::updatePosition(void) {
      ntype2 : type of node 2
      x2 : opinion of node 2
      p2 : (x, y) position of node 2 on the display
-  Return values -- 
+  Output values -- 
      The force on agent (node) 1, caused by agent (node) 2, 
-        expressed as a vector of 2 double-precision numbers.
+        in the 2 entries of $(force).
      force[0] : x-component of the force.
      force[1] : y-component of the force.
  ************************************************************************/
-vector<double> nodeList::forceFunction(int ntype1, double x1, vector<double> p1,
-				       int ntype2, double x2, vector<double> p2
-				       ) {
+void nodeList::forceFunction(int ntype1, double x1, const double *p1,
+			     int ntype2, double x2, const double *p2,
+			     double *force) {
   double difop = fabs(x1-x2); // opinion difference between the two nodes
   // The Hooke's coefficient $(spring_k) depends on the opinion difference.
   // The spring is stiffer when the opinion difference is larger.
   double spring_k = 0.01*(1.0-0.5*difop); 
-  vector<double> dist, force;
+  double dist[2];
   double distance=0.0;
   for(int i=0; i<2; i++) {
-    dist.push_back(p2.at(i) - p1.at(i));
-    distance += dist.at(i)*dist.at(i);
+    dist[i] = p2[i] - p1[i];
+    distance += dist[i]*dist[i];
   }
   distance = sqrt(distance);
-  for(int i=0; i<2; i++) {
-    double tmp = spring_k*dist.at(i)*(1.0-50.0/distance); // the force
-    force.push_back(tmp);
-  }
-  
-  return(force);
+  for(int i=0; i<2; i++)
+    force[i] = spring_k*dist[i]*(1.0-50.0/distance); // the force
 }
 
 /**************************************************************************
-  This function computes a short-ranged repulsive force 
+  This subroutine computes a short-ranged repulsive force 
      between 2 graphic agents of unconnected nodes.
   For simplicity, a step function is adopted for the repulsion, where
-     the repulsion is a constant force within a threshold distance and
-     zero beyond. 
+     the repulsion is a constant force within a threshold distance
+     $(repulsion_range) and zero beyond. 
   Inputs --
      ntype1 : type of node 1
      x1 : opinion of node 1
@@ -183,9 +238,9 @@ vector<double> nodeList::forceFunction(int ntype1, double x1, vector<double> p1,
      ntype2 : type of node 2
      x2 : opinion of node 2
      p2 : (x, y) position of node 2 on the display
-  Return values -- 
+  Output values -- 
      The force on agent (node) 1, caused by agent (node) 2, 
-        expressed as a vector of 2 double-precision numbers.
+        in the 2 entries of $(force).
      force[0] : x-component of the force.
      force[1] : y-component of the force.
   -----
@@ -195,44 +250,39 @@ vector<double> nodeList::forceFunction(int ntype1, double x1, vector<double> p1,
           interactions among individuals, a formulation of a more
           natural force should be used here.
  **************************************************************************/
-vector<double> nodeList::repulsionFunction(int ntype1, double x1,
-					   vector<double> p1,
-					   int ntype2, double x2,
-					   vector<double> p2)
+void nodeList::repulsionFunction(int ntype1, double x1, const double *p1,
+				 int ntype2, double x2, const double *p2,
+				 double *force)
 {
-  vector<double> dist, force;
+  double dist[2];
   double distance=0.0;
-  double dist_threshold = 30.0; // the threshold distance
+  double dist_threshold = repulsion_range; // the threshold distance
   for(int i=0; i<2; i++) {
-    dist.push_back(p2.at(i) - p1.at(i));
+    dist[i] = p2[i] - p1[i];
   }
-  if(dist.at(0)>dist_threshold || dist.at(0)<-dist_threshold
-     || dist.at(1)>dist_threshold || dist.at(1)<-dist_threshold) {
+  force[0] = force[1] = 0.0;
+  if(dist[0]>dist_threshold || dist[0]<-dist_threshold
+     || dist[1]>dist_threshold || dist[1]<-dist_threshold) {
     // If the distance is outside of a square box defined by the threshold
-    //   distance, assign 0 to the force.
+    //   distance, the force is 0.
     //  (Note that this is where the computations are reduced significantly:
     //   instead of computing sqrt(x^2+y^2) for every pair of agents, 
     //   we simply compare x and y to the threshold values, saving the 
     //   computation of the square root for most pairs of the agents.)
-    force.assign(2,0.0);
-    return(force);
+    return;
   } else { // Only for those close enough, we compute the distance.
     for(int i=0; i<2; i++) {
-      distance += dist.at(i)*dist.at(i);
+      distance += dist[i]*dist[i];
     }    
     distance = sqrt(distance);
     if(distance>dist_threshold) {
       // Inside the square box, there are still some pairs with a distance
-      //   larger than the threshold, we also assign 0 to the force.
-      force.assign(2,0.0);
-      return(force);
+      //   larger than the threshold, where the force is also 0.
+      return;
     }
     double mag = -0.01/(distance + 0.00001);
     for(int i=0; i<2; i++) {
-      double tmp = mag*dist.at(i); // force = A*vector(x)/(abs(x)+B), where A is a constant magnitude of the force, and B is a small positive number to prevent the denominator from going to zero.
-      force.push_back(tmp);
+      force[i] = mag*dist[i]; // force = A*vector(x)/(abs(x)+B), where A is a constant magnitude of the force, and B is a small positive number to prevent the denominator from going to zero.
     }
-    
-    return(force);
   }
 }
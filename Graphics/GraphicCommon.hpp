@@ -9,6 +9,7 @@
 #if __APPLE__
    #include<GLUT/glut.h>
 #elif __linux__
+   #define GL_GLEXT_PROTOTYPES 1 // the buffer functions of OpenGL 1.5
    #include<GL/glut.h>
 #endif
 #include<iostream>
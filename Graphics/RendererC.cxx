@@ -0,0 +1,123 @@
+/* ============================================================
+   Source codes for the graphRenderer class
+            void draw
+            void release
+            void init
+            void upload
+
+   Author: Yao-li Chuang
+   ============================================================ */
+#include"RendererC.hpp"
+
+/************************************************************************
+  This subroutine draws the snapshot $(snap): the links as gray lines
+    (if $(show_line)) and then the nodes over them as round points,
+    colored blue for positive opinions and red for negative ones.
+  The projection set by the caller maps the model coordinates to the
+    window; the points are as large as the balls of radius 2.1 that
+    the display drew before.
+*************************************************************************/
+void graphRenderer::draw(const graphSnapshot &snap, bool show_line) {
+  if(!ready) init();
+  if(&snap != last_snap || snap.time != last_time) upload(snap);
+
+  glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT | GL_POINT_BIT | GL_LINE_BIT);
+  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+  glDisable(GL_LIGHTING);
+  glDisable(GL_DEPTH_TEST); // a flat picture, drawn in order
+  glEnableClientState(GL_VERTEX_ARRAY);
+  if(use_vbo) {
+    glBindBuffer(GL_ARRAY_BUFFER, vbo[0]);
+    glVertexPointer(2, GL_FLOAT, 0, 0);
+  } else
+    glVertexPointer(2, GL_FLOAT, 0, snap.pos.data());
+
+  // Draw the links in one batch.
+  if(show_line && n_index > 0) {
+    glLineWidth(0.5);
+    glColor4f(0.3, 0.3, 0.3, 1.0);
+    if(use_vbo) {
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo[2]);
+      glDrawElements(GL_LINES, n_index, GL_UNSIGNED_INT, 0);
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    } else
+      glDrawElements(GL_LINES, n_index, GL_UNSIGNED_INT, snap.links.data());
+  }
+
+  // Draw the nodes in one batch.
+  if(n_node > 0) {
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    GLfloat size = 4.2*viewport[2]/400.0; // the diameter in pixels
+    glPointSize(size > 2.0 ? size : 2.0);
+    glEnable(GL_POINT_SMOOTH);
+    glEnableClientState(GL_COLOR_ARRAY);
+    if(use_vbo) {
+      glBindBuffer(GL_ARRAY_BUFFER, vbo[1]);
+      glColorPointer(3, GL_FLOAT, 0, 0);
+    } else
+      glColorPointer(3, GL_FLOAT, 0, color.data());
+    glDrawArrays(GL_POINTS, 0, n_node);
+  }
+  if(use_vbo) glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glPopClientAttrib();
+  glPopAttrib();
+}
+
+/************************************************************************
+  This subroutine frees the buffers of the graphics card; they are
+    made again if the renderer draws after this.
+*************************************************************************/
+void graphRenderer::release(void) {
+  if(ready && use_vbo) glDeleteBuffers(3, vbo);
+  ready = false;
+  last_snap = NULL;
+}
+
+/************************************************************************
+  This subroutine checks the version of OpenGL and makes the buffers
+    if vertex buffer objects are supported.
+*************************************************************************/
+void graphRenderer::init(void) {
+  int major = 1, minor = 0;
+  const char *version = reinterpret_cast<const char *>(glGetString(GL_VERSION));
+  if(version != NULL) sscanf(version, "%d.%d", &major, &minor);
+  use_vbo = (major > 1 || (major == 1 && minor >= 5));
+  if(use_vbo) glGenBuffers(3, vbo);
+  ready = true;
+  last_snap = NULL;
+}
+
+/************************************************************************
+  This subroutine sets the colors of the nodes of the snapshot $(snap)
+    and fills the buffers with the positions, the colors, and the
+    indices of the links.
+*************************************************************************/
+void graphRenderer::upload(const graphSnapshot &snap) {
+  n_node = snap.opinion.size();
+  n_index = snap.links.size();
+  color.resize(3*n_node);
+  for(int i=0; i<n_node; i++) {
+    float c = snap.opinion[i];
+    if(c > 0.0) { // from white (0) to blue (1)
+      color[3*i] = 1.0-c; color[3*i+1] = 1.0-c; color[3*i+2] = 1.0;
+    } else {      // from white (0) to red (-1)
+      color[3*i] = 1.0; color[3*i+1] = 1.0+c; color[3*i+2] = 1.0+c;
+    }
+  } // end of i loop
+  if(use_vbo) {
+    glBindBuffer(GL_ARRAY_BUFFER, vbo[0]);
+    glBufferData(GL_ARRAY_BUFFER, snap.pos.size()*sizeof(float),
+		 snap.pos.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo[1]);
+    glBufferData(GL_ARRAY_BUFFER, color.size()*sizeof(float),
+		 color.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo[2]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, snap.links.size()*sizeof(unsigned int),
+		 snap.links.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  }
+  last_snap = &snap;
+  last_time = snap.time;
+}
@@ -0,0 +1,66 @@
+/* ============================================================
+   Header file for the graphRenderer class
+   -----
+   Brief Summary: The renderer of the graphic display, which draws
+                  a snapshot of the model (see SnapshotC.hpp) from
+                  buffers of vertices kept by the graphics card:
+                  the nodes as one batch of round points and the
+                  links as one batch of lines indexed by the nodes.
+   -----
+      variables --
+          ready : whether the buffers have been made
+          use_vbo : whether the buffers are vertex buffer objects
+                    (OpenGL 1.5); otherwise the arrays are drawn
+                    from the memory of the program
+          vbo : vertex buffers of the positions, the colors, and
+                the indices of the links
+          last_snap, last_time : the snapshot in the buffers
+          color : RGB colors of the nodes, by their opinions
+          n_node, n_index : numbers of nodes and of link indices
+   -----
+      The buffers are filled only when a new snapshot is drawn, so
+        redrawing the same snapshot sends nothing to the graphics
+        card. Only OpenGL 1.5 is needed, so the renderer runs on
+        Mesa's software rendering as well.
+      The renderer must be used (and released) with the OpenGL
+        context current, i.e., on the thread of the display.
+   -----
+       Functions and subroutines not defined explicitly here are
+          defined in RendererC.cxx.
+
+   Author: Yao-li Chuang
+   ============================================================ */
+#ifndef __RendererC_hpp_INCLUDED__
+#define __RendererC_hpp_INCLUDED__
+
+#include"../CCommon.h"
+#include"GraphicCommon.hpp"
+#include"SnapshotC.hpp"
+
+/**************************************************************
+   graphRenderer class
+ **************************************************************/
+class graphRenderer {
+
+public:
+  // Constructor & destructor
+  graphRenderer(void) : ready(false), use_vbo(false), last_snap(NULL),
+			last_time(-1), n_node(0), n_index(0) {}
+  ~graphRenderer(void) {}
+  // Drawing
+  void draw(const graphSnapshot &snap, bool show_line);
+  void release(void); // frees the buffers of the graphics card
+
+private:
+  bool ready, use_vbo;
+  GLuint vbo[3];
+  const graphSnapshot *last_snap;
+  long int last_time;
+  vector<float> color;
+  int n_node, n_index;
+  void init(void);
+  void upload(const graphSnapshot &snap);
+};
+
+
+#endif
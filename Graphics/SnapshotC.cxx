@@ -0,0 +1,27 @@
+/* ============================================================
+   Source codes for the snapshotBuffer class
+            void publish
+            graphSnapshot &readSlot
+
+   Author: Yao-li Chuang
+   ============================================================ */
+#include"SnapshotC.hpp"
+
+/************************************************************************
+  This subroutine publishes the snapshot filled in writeSlot, which
+    becomes the ready one; the slot published before (or given back
+    by the display) is filled next.
+*************************************************************************/
+void snapshotBuffer::publish(void) {
+  writing = ready.exchange(writing | FRESH) & ~FRESH;
+}
+
+/************************************************************************
+  This function returns the latest snapshot published, which stays
+    unchanged until the next call.
+*************************************************************************/
+const graphSnapshot &snapshotBuffer::readSlot(void) {
+  if(ready.load() & FRESH)
+    reading = ready.exchange(reading) & ~FRESH;
+  return slot[reading];
+}
@@ -0,0 +1,76 @@
+/* ============================================================
+   Header file for the snapshots of the graphic display
+   -----
+   Brief Summary: A graphSnapshot holds what the display draws at
+                  one time step: the positions and the opinions of
+                  the nodes and the list of links. The simulation
+                  publishes the snapshots through a snapshotBuffer,
+                  from which the display reads the latest one
+                  without locks and without copying it.
+   -----
+      graphSnapshot variables --
+          time : time step of the snapshot
+          pos : (x, y) positions of the nodes (node i at 2i, 2i+1)
+          opinion : opinions of the nodes
+          links : the 2 nodes of each link (link l at 2l, 2l+1)
+      snapshotBuffer variables --
+          slot : the 3 snapshots (triple buffering)
+          writing : the slot being filled by the simulation
+          reading : the slot being drawn by the display
+          ready : the slot published last, with the flag FRESH
+                  if the display has not taken it yet
+   -----
+      The simulation fills writeSlot and calls publish, which swaps
+        it with the ready slot; the display calls readSlot, which
+        swaps the reading slot with the ready one if it is fresh.
+        Each side thus owns one slot at any time, and a snapshot is
+        never changed while it is drawn. A snapshot published before
+        the display took the previous one replaces it.
+      Only one thread may write and only one thread may read.
+   -----
+       Functions and subroutines not defined explicitly here are
+          defined in SnapshotC.cxx.
+
+   Author: Yao-li Chuang
+   ============================================================ */
+#ifndef __SnapshotC_hpp_INCLUDED__
+#define __SnapshotC_hpp_INCLUDED__
+
+#include"../CCommon.h"
+#include<atomic>
+
+/**************************************************************
+   The data drawn by the display at one time step
+ **************************************************************/
+struct graphSnapshot {
+  long int time;
+  vector<float> pos;
+  vector<float> opinion;
+  vector<unsigned int> links;
+};
+
+/**************************************************************
+   snapshotBuffer class
+ **************************************************************/
+class snapshotBuffer {
+
+public:
+  // Constructor & destructor
+  snapshotBuffer(void) : writing(0), reading(1), ready(2) {}
+  ~snapshotBuffer(void) {}
+  // The simulation side
+  graphSnapshot &writeSlot(void) {return slot[writing];}
+  void publish(void);
+  // The display side
+  bool hasFresh(void) {return (ready.load() & FRESH) != 0;}
+  const graphSnapshot &readSlot(void); // the latest snapshot
+
+private:
+  static const int FRESH = 4;
+  graphSnapshot slot[3];
+  int writing, reading;
+  atomic<int> ready;
+};
+
+
+#endif
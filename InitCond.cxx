@@ -0,0 +1,82 @@
+/* ============================================================
+   Subroutines handling the initial conditions of a simulation.
+      read_init_cond - reads the initial conditions from an input file.
+      create_node_list - creates the list of nodes accordingly.
+
+   Author: Yao-li Chuang
+   ============================================================ */
+#include "InitCond.H"
+
+/******************************************************************
+ This subroutine reads the initial conditions from an input file.
+  Input ---
+     file_name: name of the input file
+     ini: the initial conditions to be overwritten by the values
+          found in the file
+ +++++
+  Note ---
+     Whenever a new parameters for the initial conditions is added
+     here, remember to set an exception in the subroutine
+     resetParametersFromFile in Model/ModelC.cxx, or else 
+     it will return an error message.
+ ******************************************************************/
+void read_init_cond(string file_name, struct iniConditions &ini) {
+  string line;
+  ifstream input_file(file_name.data());
+  if (input_file.is_open()) {
+    while (getline(input_file, line)) {
+      stringstream line_stream(line);
+      string pname;
+      line_stream >> pname;
+      if(pname.compare("n_node")==0) {
+	line_stream >> ini.n_node;
+      } else if(pname.compare("immigrant_number")==0) {
+	line_stream >> ini.immigrant_number;
+      } else if(pname.compare("immigrant_ratio")==0) {
+	line_stream >> ini.immigrant_ratio;
+      } else if(pname.compare("initial_connections")==0) {
+	line_stream >> ini.initial_connections;
+      } else if(pname.compare("initial_opinions")==0) {
+	line_stream >> ini.initial_opinions;
+      } else if(pname.compare("checkpoint_file")==0) {
+	line_stream >> ini.checkpoint_file;
+      } else if(pname.compare("checkpoint_every")==0) {
+	line_stream >> ini.checkpoint_every;
+      } else if(pname.compare("frame_prefix")==0) {
+	line_stream >> ini.frame_prefix;
+      } else if(pname.compare("frame_every")==0) {
+	line_stream >> ini.frame_every;
+      } // end of if pname is some string statement
+    } // end of getline from input_file loop
+    input_file.close();
+  } else {
+    cout << "Error in read_init_cond in InitCond.cxx: unable to open " << file_name.data() << endl;
+    cout << "      The simulation will proceed with the default parameter values." << endl;
+  } // end of if file is open statement
+}
+
+/******************************************************************
+ This function creates a list of nodes from the initial conditions.
+  Input ---
+     ini: the initial conditions
+     seed: seed of the random numbers (0: a random seed)
+  Return value ---
+     A pointer to the new list of nodes (to be deleted by the caller)
+ +++++
+  Note ---
+     $(ini.immigrant_number) defines the number of guest nodes if it
+     is not zero; otherwise, $(ini.immigrant_ratio) defines the ratio
+     of guest nodes.
+ ******************************************************************/
+nodeList *create_node_list(struct iniConditions &ini, uint64_t seed) {
+  if(ini.immigrant_number != 0)
+    return new nodeList(ini.n_node,
+			static_cast<int>(ini.immigrant_number),
+			ini.initial_connections,
+			ini.initial_opinions, seed);
+  else
+    return new nodeList(ini.n_node, 
+			static_cast<double>(ini.immigrant_ratio),
+			ini.initial_connections,
+			ini.initial_opinions, seed);
+}
@@ -4,40 +4,58 @@
    -----
    Subroutines related to model simulation:
       init_model - sets the initial conditions and model parameters.
-      read_init_cond - reads the initial conditions from an input file.
+      simulate - the loop of the simulation thread
+      stop_simulation - stops the simulation thread
       model - runs model simulations
+      publish_frame - publishes a snapshot of the model for the display
       output - writes simulations to the terminal.
    Subroutines related to graphic display:
       init_Graph - sets graphic parameters.
       display - displays the initial graphics (i.e., the initial conditions)
       idle - executes tasks while the graphic display is not updating
       keys - defines the tasks of keyboard inputs
-      MaterialProperties - defines the material properties of graphic objects
-      LightingProerties - defines the lighting enviroment of the display
+   -----
+   The model simulation runs on its own thread, so that a slow time
+   step does not freeze the window and a slow frame does not stall
+   the simulation. The simulation publishes snapshots of the model
+   through the triple buffer $(frames) (see Graphics/SnapshotC.hpp),
+   from which display draws the latest one. The graphic layout is
+   updated only when the display asks for a new frame, and the
+   keys that read the model are handled on the simulation thread.
+   The snapshots are drawn by $(renderer) (see Graphics/RendererC.hpp).
+
+   The initial conditions are read in InitCond.cxx, which is shared
+   with the headless batch program Batch.cxx.
 
    Author: Yao-li Chuang
    ============================================================ */
 #include "Main.H"
-#include "Node/NodeListC.hpp"
+#include "InitCond.H"
+#include"Parallel/ThreadPoolC.hpp"
 #include"Graphics/GraphicCommon.hpp"
+#include"Graphics/SnapshotC.hpp"
+#include"Graphics/RendererC.hpp"
+#include<thread>
+#include<atomic>
+#include<chrono>
 
 // Global vairables for the model simulation
 nodeList *nlist;         // List of nodes
+threadPool *pool;        // Threads running the model simulation
 long int t = 0;          // time 
-struct iniConditions {   // Parameters for the initial conditions
-  int n_node;
-  int immigrant_number;
-  double immigrant_ratio; // It is used only when immigrant_number=0.
-  int initial_connections;
-  double initial_opinions;
-} initial_conditions = { 500, 50, 0.1, 5, 1.0 }; // default values
+struct iniConditions initial_conditions = { 500, 50, 0.1, 5, 1.0, "", 0, "", 0 }; // default values
+thread sim_thread;       // Thread running the model simulation
+
+// Global variables shared by the simulation and the graphic display
+snapshotBuffer frames;            // snapshots drawn by the display
+atomic<bool> frame_wanted(true);  // the display asks for a new frame
+atomic<int> run_id(0);            // 1: the simulation is running
+atomic<int> key_request(0);       // key read on the simulation thread
+atomic<bool> quitting(false);
 
 // Global variables for the graphic display
-double *x,*c;
-bool *connection;
-GLUquadricObj *myquadric;
+graphRenderer renderer;
 int show_line=1;
-int run_id=0;
 
 
 /********************************************
@@ -47,7 +65,7 @@ int run_id=0;
   1. The simulation model is initiated.
   2. The graphic interface is initiated.
   3. Several graphic display functions are set.
-  4. The model simulation runs in the idle function. 
+  4. The model simulation runs on its own thread (see simulate).
   -----
   The current version takes no arguments. 
   All the parameter values are hard-coded
@@ -63,12 +81,18 @@ int main(int argc, char* argv[]) {
   void display(void);
   void keys(unsigned char, int, int);
   void idle(void);
+  void simulate(void);
+  void stop_simulation(void);
 
   // Initiate the model
   string file_name = "";
   if (argc == 2)
     file_name.assign(argv[1]);
   init_model(file_name);
+  sim_thread = thread(simulate);
+  // GLUT calls exit when the window is closed, so the simulation
+  //   thread is stopped at exit however the program ends.
+  atexit(stop_simulation);
 
   // Initiate the graphic interface
   glutInit(&argc, argv);
@@ -102,16 +126,11 @@ void init_graph() {
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
   glClearColor(1.0, 1.0, 1.0, 1.0);
   glEnable(GL_DEPTH_TEST);
-  glEnable(GL_LIGHTING);
-  glEnable(GL_LIGHT0);
   //glColor3f(0.0, 0.0, 0.0);
   glMatrixMode(GL_PROJECTION);
-  glOrtho(-200, 200, -200, 200, -200, 200);
-
-  // Initiate an openGL quadric object, which will be defined as a ball
-  //   later, used to reprent each node in the graphic display
-  myquadric = gluNewQuadric();
-  gluQuadricDrawStyle(myquadric, GLU_FILL);
+  // the view grows with the initial discs of the agents
+  double w = 200.0*nodeList::layoutScale(nlist->getNumMemberNodes());
+  glOrtho(-w, w, -w, w, -200, 200);
 }
 
 /**************************************************************
@@ -123,9 +142,6 @@ void init_graph() {
     objects are modified.
  **************************************************************/
 void display() {
-  void MaterialProperties(float, float, float);
-  void LightingProperties(void);
-
   // clear the display
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -135,95 +151,14 @@ void display() {
   //gluLookAt(0.0, 0.0, 2.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0);
   //glRotatef(-90, 1.0, 0.0, 0.0); // Rotate to a more conventional orientation
 
-  // set the lights
-  LightingProperties();
-
-  vector<node> tmpnode = nlist->getMemberNodes();
-  int totalN = tmpnode.size();
-  // Draw lines between connected nodes
-  if(show_line==1) {
-    glLineWidth(0.5);
-    glBegin(GL_LINES);
-    for(int i=0; i<totalN; i++)
-      for(int j=i+1; j<totalN; j++)
-	if(tmpnode[i].checkAConnection(tmpnode[j].getId())>=0) {
-	  glVertex3d(tmpnode[i].getGraphAgent().getPos()[0], 
-		     tmpnode[i].getGraphAgent().getPos()[1], 0.0);
-	  glVertex3d(tmpnode[j].getGraphAgent().getPos()[0], 
-		     tmpnode[j].getGraphAgent().getPos()[1], 0.0);
-	}
-    glEnd();
-  }
-  // Draw the nodes as balls
-  for(int i=0; i<totalN; i++) {
-    glPushMatrix();
-    glPushAttrib(GL_LIGHTING_BIT);
-    // Draw the hosts and the guests with different colors 
-    //   (defined in the MaterialProperties subroutine) 
-    if(c[i]>0.0)
-      MaterialProperties(1.0-c[i],1.0-c[i],1.0);
-    else
-      MaterialProperties(1.0,1.0+c[i],1.0+c[i]);
-    glTranslated(tmpnode[i].getGraphAgent().getPos()[0],
-		 tmpnode[i].getGraphAgent().getPos()[1], 0.0);
-    glScaled(3.0,3.0,3.0);
-    gluSphere(myquadric, 0.7, 15, 15); // define the object as a sphere
-    glPopAttrib();
-    glPopMatrix();
-  }
+  // Draw the links and the nodes of the latest snapshot of the model,
+  //   which is read in place; the simulation does not change it
+  //   while it is drawn.
+  renderer.draw(frames.readSlot(), show_line==1);
 
   glutSwapBuffers();  // Show the drawn objects in the display
 }
 
-/****************************************************************
-  This subroutine defines the material properties of 
-      the openGL objects. Here we can change the RGB
-      values of the color.
-  Input --
-     r : red    (0.0 <= r <= 1.0)
-     g : green  (0.0 <= g <= 1.0)
-     b : blue   (0.0 <= b <= 1.0)
-  --------
-   There are online resources for openGL material settings.
-   For example:
-      http://devernay.free.fr/cours/opengl/materials.html
- ****************************************************************/
-void MaterialProperties(float r, float g, float b) {
-	GLfloat ambient[4], diffuse[4], specular[4], shininess=32.0;
-	GLfloat mat_color[3] = { r, g, b };
-	
-	for(int i=0; i<3; i++) {
-	  //	ambient[i] = 0.3*mat_color[i];
-	  //	diffuse[i] = 0.6*mat_color[i];
-	  //	specular[i] = 0.6+0.2*mat_color[i];
-		ambient[i] = 0.05*mat_color[i];
-		diffuse[i] = 0.4+0.1*mat_color[i];
-		specular[i] = 0.04+0.66*mat_color[i];
-	}
-	shininess = 0.078125;
-	ambient[3] = diffuse[3] = specular[3] = 1.0;
-
-	glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, ambient);
-	glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, diffuse);
-	glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, specular);
-	glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, shininess);	
-}
-
-/****************************************************************
-  This subroutine defines the lighting of the display. 
- ****************************************************************/
-void LightingProperties(void) {
-  float ambient[] = {0.0, 0.0, 0.0, 1.0};
-  float lightings[] = {1.0, 1.0, 1.0, 1.0};
-  float position[] = {0.5,0.5,1.0,0.0};
-  glLightfv(GL_LIGHT0, GL_AMBIENT, ambient);
-  glLightfv(GL_LIGHT0, GL_DIFFUSE, lightings);
-  glLightfv(GL_LIGHT0, GL_SPECULAR, lightings);
-
-  // Define the direction of the diffuse and the specular lights.
-  glLightfv(GL_LIGHT0, GL_POSITION, position);
-}
-
 /****************************************************************
   This subroutine defines the key functions.
   Input --
@@ -239,12 +174,12 @@ void LightingProperties(void) {
      c: print the current number of clusters in the terminal
  ****************************************************************/
 void keys(unsigned char k, int x, int y) {
+  void stop_simulation(void);
+
   switch(k) {
      case 'c':
-       cout << "Number of clusters = " << nlist->numCluster() << endl;
-       break;
      case 'd':
-       nlist->degreeConnectionSnapshot(20);
+       key_request = k; // handled by the simulation thread
        break;
      case 'l':
        show_line=1-show_line;
@@ -253,7 +188,8 @@ void keys(unsigned char k, int x, int y) {
        run_id=1-run_id;
        break;
      case 'q':
-       gluDeleteQuadric(myquadric);
+       stop_simulation();
+       renderer.release();
        exit(0);
        break;
        /*
@@ -270,68 +206,76 @@ void keys(unsigned char k, int x, int y) {
  This subroutine initiates the model.
  ******************************************************************/
 void init_model(string file_name) {
-  void read_init_cond(string);
 
   // If an input file is given, read the initial conditions from it.
   if(file_name.length()>0)
-    read_init_cond(file_name); 
-  // Use $(initial_conditions.immigrant_number) to define the number of 
-  //   guest nodes if it is not zero; 
-  //   otherwise, use $(initial_conditions.immigrant_ratio) to define 
-  //   the ratio of guest nodes.
-  if(initial_conditions.immigrant_number != 0)
-    nlist = new nodeList(initial_conditions.n_node,
-			 static_cast<int>(initial_conditions.immigrant_number),
-			 initial_conditions.initial_connections,
-			 initial_conditions.initial_opinions);
-  else
-    nlist = new nodeList(initial_conditions.n_node, 
-			 static_cast<double>(initial_conditions.immigrant_ratio),
-			 initial_conditions.initial_connections,
-			 initial_conditions.initial_opinions);
+    read_init_cond(file_name, initial_conditions); 
+  // Create the list of nodes (see InitCond.cxx)
+  nlist = create_node_list(initial_conditions);
+  // Run the model simulation on all cores of the hardware.
+  pool = new threadPool();
+  nlist->setThreadPool(pool);
   //nlist->hostInitiation();
   // If an input file is given, read the model parameters from it.
   if(file_name.length()>0)
     nlist->resetParametersFromFile(file_name);
 
-  // The vector $(x) and $(c) obtain respectively the (x,y) coordinates
-  //     and the opinions to draw the nodes in the graphic display later 
-  int n_node = initial_conditions.n_node;
-  x = new double[2*n_node];
-  c = new double[n_node];
-  vector<node> node_list = nlist->getMemberNodes();
-  for(int i=0; i<n_node; i++) {
-    vector<double> tmpos;
-    tmpos = node_list[i].getGraphAgent().getPos();
-    x[i] = tmpos[0];
-    x[i+n_node] = tmpos[1];
-    c[i] = node_list[i].getOpinion();
-  }
-
-  // The boolean vector $(connection) specify if there is a connection
-  //   between a pair of nodes; here we initiate it with no connections
-  //   at all (false) and will update it later.
-  int n_square = n_node*n_node;
-  connection = new bool[n_square];
-  for(int i=0; i<n_square; i++) connection[i] = false;
+  // The first snapshot shows the initial conditions.
+  nlist->writeSnapshot(frames.writeSlot());
+  frames.publish();
+  frame_wanted = false;
 }
 
 /******************************************************************
  The idle function tells glutMainLoop what to do while the main
-    loop is running.
+    loop is running: it redraws the display when a new snapshot is
+    published, and otherwise asks the simulation for one.
  ******************************************************************/
 void idle(void) {
+  if(frames.hasFresh())
+    glutPostRedisplay(); // redraw the display
+  else {
+    frame_wanted = true;
+    this_thread::sleep_for(chrono::milliseconds(1)); // not to spin
+  }
+}
+
+/******************************************************************
+ The loop of the simulation thread, which runs the model while
+    $(run_id) is set, publishes a snapshot when the display asks
+    for a frame, and handles the keys that read the model.
+ ******************************************************************/
+void simulate(void) {
   void model(int);
   void output(void);
 
-  // $(run_id) toggles between running and pausing the model simualtion.
-  if(run_id) {
-    model(10);     // simulating the model
-    if(t%10==0)  // output the results every 10 steps
-       output();
-    //run_id = 1-run_id;    // if we want to pause the simulation after every step
-  }
-  glutPostRedisplay(); // redraw the display
+  while(!quitting) {
+    int k = key_request.exchange(0);
+    if(k == 'c')
+      cout << "Number of clusters = " << nlist->numCluster() << endl;
+    else if(k == 'd')
+      nlist->degreeConnectionSnapshot(20);
+    // $(run_id) toggles between running and pausing the model simualtion.
+    if(run_id) {
+      model(10);     // simulating the model
+      if(t%10==0)  // output the results every 10 steps
+	output();
+      //run_id = 0;    // if we want to pause the simulation after every step
+    } else
+      this_thread::sleep_for(chrono::milliseconds(10));
+  } // end of while loop
+}
+
+/******************************************************************
+ This subroutine stops the simulation thread and waits for it to
+    finish its time steps; it is called by the key 'q' and at exit
+    (a running thread left to the destructor of $(sim_thread) would
+    abort the program).
+ ******************************************************************/
+void stop_simulation(void) {
+  quitting = true;
+  if(sim_thread.joinable())
+    sim_thread.join();
 }
 
 /******************************************************************
@@ -339,71 +283,29 @@ void idle(void) {
   Input ---
      t_steps: number of time steps for the model to proceed
   No return values ---
-     The results will be updated to the global variables $(x) and $(c)
-     for the other openGL subroutines to draw the graphics.
+     If the display has asked for a frame, the graphic layout is
+     updated and a new snapshot is published (see publish_frame).
  ******************************************************************/
 void model(int t_steps) {
+  void publish_frame(void);
+
   for(int i=0; i<t_steps; i++)
     nlist->nextTimeStep();
   t += t_steps;
-
-  // Update the global variables $(x) and $(c)
-  vector<node> node_list = nlist->getMemberNodes();
-  int n_node = nlist->getNumMemberNodes();
-  for(int i=0; i<n_node; i++) {
-    vector<double> tmpos;
-    tmpos = node_list[i].getGraphAgent().getPos();
-    x[i] = tmpos[0];
-    x[i+n_node] = tmpos[1];
-    c[i] = node_list[i].getOpinion();
-  }
-
+  if(frame_wanted.exchange(false))
+    publish_frame();
 }
 
 /******************************************************************
- This subroutine reads the initial conditions from an input file.
-  Input ---
-     file_name: name of the input file
- +++++
-  Note ---
-     Whenever a new parameters for the initial conditions is added
-     here, remember to set an exception in the subroutine
-     resetParametersFromFile in Model/ModelC.cxx, or else 
-     it will return an error message.
+  This subroutine updates the graphic agents for the visual display
+    and publishes a snapshot of the model for the display.
  ******************************************************************/
-void read_init_cond(string file_name) {
-  string line;
-  ifstream input_file(file_name.data());
-  if (input_file.is_open()) {
-    while (getline(input_file, line)) {
-      stringstream line_stream(line);
-      string pname;
-      line_stream >> pname;
-      if(pname.compare("n_node")==0) {
-	int value;
-	line_stream >> initial_conditions.n_node;
-      } else if(pname.compare("immigrant_number")==0) {
-	int value;
-	line_stream >> initial_conditions.immigrant_number;
-      } else if(pname.compare("immigrant_ratio")==0) {
-	double value;
-	line_stream >> initial_conditions.immigrant_ratio;
-      } else if(pname.compare("initial_connections")==0) {
-	int value;
-	line_stream >> initial_conditions.initial_connections;
-      } else if(pname.compare("initial_opinions")==0) {
-	double value;
-	line_stream >> initial_conditions.initial_opinions;
-      } // end of if pname is some string statement
-    } // end of getline from input_file loop
-    input_file.close();
-  } else {
-    cout << "Error in read_init_cond in Main.cxx: unable to open " << file_name.data() << endl;
-    cout << "      The simulation will proceed with the default parameter values." << endl;
-  } // end of if file is open statement
+void publish_frame(void) {
+  nlist->updateGraphData();
+  nlist->writeSnapshot(frames.writeSlot());
+  frames.publish();
 }
 
-
 /******************************************************************
   This subroutine prints the statistical results in the terminal
  ******************************************************************/
@@ -412,18 +314,15 @@ void output(void) {
   // Update the statistics
   nlist->computeStats();
 
-  struct modelStats stats = nlist->getStats(); // get the statistics
+  const struct modelStats &stats = nlist->getStats(); // get the statistics
 
-  vector<double> alink = stats.avg_link, aut=stats.avg_ut, aop=stats.avg_op, arw=stats.avg_rw;
+  const vector<double> &alink = stats.avg_link, &aut=stats.avg_ut, &aop=stats.avg_op;
   cout << "Time = " << t << '\n';
-  double guest_ratio = static_cast<double>(nlist->getNumGuest())
-                      /static_cast<double>(nlist->getNumMemberNodes());
   cout << "Average number of links per node: all, h2h/h, h2g/h, g2h/g, g2g/g " << '\n';
   for(int i=0; i<5; i++)
     cout << '\t' << alink.at(i);
   cout << '\n';
-  double iint = (alink.at(3)/(alink.at(3)+alink.at(4)))/(1-guest_ratio);
-  cout << "Indicator of guest integration = " << iint << '\n';
+  cout << "Indicator of guest integration = " << stats.integration << '\n';
   cout << "Average utility per node: all, host, guest " << '\n';
   for(int i=0; i<3; i++)
     cout << '\t' << aut.at(i);
@@ -432,10 +331,7 @@ void output(void) {
   for(int i=0; i<3; i++)
     cout << '\t' << aop.at(i);
   cout << '\n';
-  double uguest = aut.at(2)/aut.at(1);
-  double cross_ratio = 2.0*guest_ratio*(1.0-guest_ratio);
-  double rwcross = (arw.at(3)/arw.at(0))/cross_ratio;
-  cout << "Guest utility compares to host utility = " << uguest << '\n' << "Rewards through host-guest links compares to the fair share = " << rwcross << '\t';
+  cout << "Guest utility compares to host utility = " << stats.ut_ratio << '\n' << "Rewards through host-guest links compares to the fair share = " << stats.rw_cross << '\t';
     
   cout << endl;
   //if(alink.at(3)<0.001) run_id=0; // pause the simulation
@@ -0,0 +1,305 @@
+/* ============================================================
+   Source codes for the nodeList data class (part V)
+   This file contains subroutines and functions of the event-
+     driven engine, which nextTimeStep runs instead of the
+     updates of all nodes when the parameter event_driven is set.
+            void runEvents
+	    void initEvents
+	    void opinionEvent
+	    void linkEvent
+	    double opinionRate
+	    double linkRate
+	    bool cutAccepted
+	    void countCuttable
+	    void setEventRate
+   -----
+    Note:
+       In continuous time, every node updates its opinion and
+          proposes a link (as in updateOpinion2 and evolveAdjMatrix)
+          at the rate 1 each, i.e., once per unit of time on average
+          and in a random order, and a time step is one unit of time.
+       Event 2i is the opinion update of node i and event 2i+1 the
+          link proposal of node i. The time of the next occurrence
+          of every event is kept in the indexed priority queue
+          $(events) (see EventQueueC.hpp); after each event, only
+          the rates of the events of the nodes it changed are
+          updated (the next-reaction method of Gibson and Bruck).
+       Events that would change nothing are left out of the rates,
+          so the time is spent on the changes that happen:
+       -- An opinion update draws no partner with the probability
+          welfare / (total_utility + welfare). The rate of the opinion
+          updates of node i is thus total_utility[i] / (total_utility[i]
+          + welfare), and every update draws a partner.
+       -- Node i is saturated if no new link would pay for its extra
+          cost, even with the largest utility max(AH, AG). Its proposals
+          then only cut one of the $(n_cuttable)[i] links that it would
+          cut if proposed, out of the n_active-1 candidates, so the rate
+          of its proposals is n_cuttable[i]/(n_active-1), and every
+          proposal cuts one of these links with equal probability.
+          After burn-in, most nodes are saturated and have no link to
+          cut, and they propose nothing at all.
+          The proposals of the other nodes are made at the rate 1 and
+          decided by decideLink as in evolveAdjMatrix.
+       -- An opinion update that leaves the opinion within ut_epsilon
+          of the one the utilities of its links were computed from
+          ($(op_ut)) keeps these utilities, as updateUtMatrix does,
+          and changes no rates.
+       The engine saves the link proposals, not the opinion updates:
+          each node still updates its opinion about once per unit of
+          time, and every update recomputes all the links of the node
+          one by one, so each link is recomputed about twice per unit
+          of time against once per step in the pass of updateUtMatrix.
+          With the opinions moving, the engine is thus several times
+          slower than the time steps (about 3.5x for 10000 nodes),
+          which remain the way of the long runs; the engine pays off
+          when the opinions are fixed (enable_op 0; about 2.5x faster
+          after burn-in) or settle within a ut_epsilon > 0.
+       Idling nodes have no events and are never proposed to.
+       The random numbers of node i are drawn from the counters of
+          node i in the stream RNG_EVENT, numbered by $(event_draw)[i]
+          within the time step. The events run in the order of their
+          times on one thread, so the results are defined by the seed.
+
+   Author: Yao-li Chuang
+   ============================================================ */
+#include"../Node/NodeListC.hpp"
+
+/******************************************************************
+  This subroutine runs the events for the span of time $(t_span)
+    from the current state of the network.
+  The utilities must be up-to-date; they are kept so by the events.
+  -----
+  The schedule of the events is kept from one call to the next,
+    unless something other than the events has changed the network,
+    the parameters, or the idling nodes ($(events_up2date) is false).
+    It is then drawn anew by initEvents; since the waiting times of
+    the events are exponential (memoryless), this does not change
+    the dynamics.
+ ******************************************************************/
+void nodeList::runEvents(double t_span) {
+  int n=opinion.size();
+  if(n == 0) return;
+  event_draw.assign(n, 0); // the counters of this time step
+  if(!events_up2date || events.size() != 2*n) initEvents();
+  double t_end = event_time + t_span;
+  for(;;) {
+    int id = events.top();
+    if(events.topTime() >= t_end) break; // including INFINITY
+    event_time = events.topTime();
+    int i = id/2;
+    if(id%2 == 0) {
+      opinionEvent(i);
+      setEventRate(id, opinionRate(i), true);
+    } else {
+      linkEvent(i);
+      setEventRate(id, linkRate(i), true);
+    } // end of if-else (opinion event) statement
+  } // end of for loop
+  event_time = t_end;
+  edges.sumRewards(link_rw); // clearing the rounding of the updates
+  compactEdges();
+}
+
+/******************************************************************
+  This subroutine sets the total utilities, the numbers of the
+    links to cut, and the rates of all events, and draws the time
+    of the first occurrence of each event from the time 0.
+ ******************************************************************/
+void nodeList::initEvents(void) {
+  int n=opinion.size();
+  n_active = 0;
+  for(int i=0; i<n; i++)
+    if(!idling[i]) n_active++;
+  n_cuttable.resize(n);
+  saturated.resize(n);
+  event_rate.assign(2*n, 0.0);
+  event_time = 0.0;
+  vector<double> t(2*n, INFINITY);
+  forEachNodeRange([&](int first, int last) {
+    for(int i=first; i<last; i++) {
+      double tut = 0.0;
+      for(int k=0; k<num_link[i]; k++)
+	tut += linkUtility(i, k);
+      total_utility[i] = tut;
+      countCuttable(i);
+      event_rate[2*i] = opinionRate(i);
+      event_rate[2*i+1] = linkRate(i);
+      for(int id=2*i; id<=2*i+1; id++)
+	if(event_rate[id] > 0.0)
+	  t[id] = -log(1.0 - rng.uniform(time_step, i, RNG_EVENT, event_draw[i]++))
+	    / event_rate[id];
+    } // end of i loop
+  }); // end of forEachNodeRange
+  events.assign(t);
+  events_up2date = true;
+}
+
+/******************************************************************
+  This subroutine moves the opinion of node $(i) towards that of
+    one of its partners, drawn with a probability proportional to
+    the utility it gives node i, and updates the utilities of the
+    links of node i and the rates of the events of its partners.
+ ******************************************************************/
+void nodeList::opinionEvent(int i) {
+  int nlinki = num_link[i];
+  double target = total_utility[i]
+    * rng.uniform(time_step, i, RNG_EVENT, event_draw[i]++);
+  double acc = 0.0;
+  int k = 0;
+  for(; k<nlinki-1; k++) { // the last one if rounding leaves none
+    acc += linkUtility(i, k);
+    if(target < acc) break;
+  } // end of k loop
+  double result = (par.kappa*opinion[i] + opinion[adjList[i][k]])
+    /(par.kappa+1.0);
+  // set the result to 0 if the new opinion goes to the other side
+  int ntype = node_type[i];
+  if((ntype==1 && result<0) || (ntype==-1 && result>0))
+    result = 0;
+  opinion[i] = result;
+  // The links of node i keep their utilities while its opinion stays
+  //   within ut_epsilon of the one they were computed from, as in
+  //   updateUtMatrix; nothing else changes then.
+  if(op_ut.size() == opinion.size()) {
+    if(fabs(result - op_ut[i]) <= par.ut_epsilon) return;
+    op_ut[i] = result; // the links of node i are recomputed below
+  }
+
+  // Update the utilities of the links of node i.
+  double tut = 0.0;
+  for(k=0; k<nlinki; k++) {
+    int j = adjList[i][k], e = adjEdge[i][k];
+    double ij_old = edges.getUtility(e, i), ji_old = edges.getUtility(e, j);
+    double ut_ij, ut_ji;
+    utilityPair(i, j, ut_ij, ut_ji);
+    edges.setUtilities(e, i, ut_ij, ut_ji);
+    link_rw[linkType(i, j)] += (ut_ij - ij_old) + (ut_ji - ji_old);
+    tut += ut_ij;
+    if(ut_ji == ji_old) continue; // nothing of node j has changed
+    total_utility[j] += ut_ji - ji_old;
+    setEventRate(2*j, opinionRate(j), false);
+    if(saturated[j]) { // (n_cuttable is recounted when j gets saturated)
+      int cut_change = static_cast<int>(cutAccepted(j, ut_ji))
+	- static_cast<int>(cutAccepted(j, ji_old));
+      if(cut_change == 0) continue; // the rate of its proposals is kept
+      n_cuttable[j] += cut_change;
+      setEventRate(2*j+1, linkRate(j), false);
+    } // end of if (node j saturated) statement
+  } // end of k loop
+  total_utility[i] = tut;
+  if(saturated[i]) countCuttable(i);
+  setEventRate(2*i+1, linkRate(i), false);
+}
+
+/******************************************************************
+  This subroutine lets node $(i) propose to add a link or to cut
+    one, and updates the rates of the events of nodes i and j if
+    a link between them is added or cut.
+ ******************************************************************/
+void nodeList::linkEvent(int i) {
+  int j, decision;
+  double ut_ij, ut_ji;
+  if(saturated[i]) {
+    // cut one of the links that node i would cut, by equal chance
+    int c = static_cast<int>(n_cuttable[i]
+		  * rng.uniform(time_step, i, RNG_EVENT, event_draw[i]++));
+    if(c >= n_cuttable[i]) c = n_cuttable[i]-1;
+    int k = 0;
+    for(;; k++) {
+      j = adjList[i][k];
+      if(!idling[j] && cutAccepted(i, linkUtility(i, k)) && c-- == 0) break;
+    } // end of k loop
+    decision = -1;
+  } else {
+    j = selectCandidate(i, RNG_EVENT, &event_draw[i]);
+    decision = decideLink(i, j, ut_ij, ut_ji);
+  } // end of if-else (node i saturated) statement
+
+  if(decision == 0) return;
+  if(decision == 1) {
+    addLink(i, j, ut_ij, ut_ji);
+  } else { // the utilities lost by nodes i and j
+    ut_ij = -linkUtility(i, findLink(i, j));
+    ut_ji = -linkUtility(j, findLink(j, i));
+    cutLink(i, j);
+  } // end of if-else (link added) statement
+  total_utility[i] += ut_ij;
+  total_utility[j] += ut_ji;
+  // The numbers of links of nodes i and j have changed.
+  countCuttable(i);
+  countCuttable(j);
+  setEventRate(2*i, opinionRate(i), false);
+  setEventRate(2*j, opinionRate(j), false);
+  setEventRate(2*j+1, linkRate(j), false);
+}
+
+/******************************************************************
+  These functions return the rates of the opinion updates and of
+    the link proposals of node $(i) (see the note at the top).
+ ******************************************************************/
+double nodeList::opinionRate(int i) {
+  if(!par.enable_op || idling[i] || num_link[i]==0) return 0.0;
+  double tut = total_utility[i];
+  if(tut <= 0.0) return 0.0; // no partner can be drawn
+  return tut/(tut + par.welfare);
+}
+
+double nodeList::linkRate(int i) {
+  if(!par.enable_net || idling[i] || n_active < 2) return 0.0;
+  if(!saturated[i]) return 1.0;
+  return static_cast<double>(n_cuttable[i])/static_cast<double>(n_active-1);
+}
+
+/******************************************************************
+  This function returns whether node $(i) would cut its link of
+    the utility $(ut), by the same comparison as in decideLink.
+ ******************************************************************/
+bool nodeList::cutAccepted(int i, double ut) {
+  int nlinki = num_link[i];
+  return -ut - linkCost(nlinki-1) >= -linkCost(nlinki);
+}
+
+/******************************************************************
+  This subroutine counts the links that node $(i) would cut if
+    proposed, i.e., those to partners that are not idling, into
+    $(n_cuttable)[i], and sets whether node i is saturated, i.e.,
+    it would not add even a link of the largest possible utility,
+    by the same comparison as in decideLink.
+  n_cuttable[i] is used and kept up-to-date only while node i is
+    saturated, which changes only with the number of its links.
+ ******************************************************************/
+void nodeList::countCuttable(int i) {
+  int nlinki = num_link[i];
+  int cnt = 0;
+  for(int k=0; k<nlinki; k++)
+    if(!idling[adjList[i][k]] && cutAccepted(i, linkUtility(i, k)))
+      cnt++;
+  n_cuttable[i] = cnt;
+  double ut_max = max(max(utc.A_same, utc.A_cross), 0.0);
+  saturated[i] = (ut_max - linkCost(nlinki+1) < -linkCost(nlinki));
+}
+
+/******************************************************************
+  This subroutine changes the rate of the event $(id) to $(rate)
+    and reschedules the event.
+  Input values:
+     $(fired) is true if the event has just occurred, for which a
+        new waiting time is drawn. Otherwise, the remaining waiting
+        time is scaled by the ratio of the old and the new rates.
+ ******************************************************************/
+void nodeList::setEventRate(int id, double rate, bool fired) {
+  double rate_old = event_rate[id];
+  if(rate == rate_old && !fired) return;
+  event_rate[id] = rate;
+  double t;
+  if(rate <= 0.0)
+    t = INFINITY;
+  else if(rate_old > 0.0 && !fired)
+    t = event_time + (events.getTime(id) - event_time)*(rate_old/rate);
+  else {
+    int i = id/2; // the node of the event
+    t = event_time
+      - log(1.0 - rng.uniform(time_step, i, RNG_EVENT, event_draw[i]++))/rate;
+  }
+  events.update(id, t);
+}
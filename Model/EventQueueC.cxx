@@ -0,0 +1,70 @@
+/* ============================================================
+   Source codes for the eventQueue class
+            void assign
+            void update
+            void siftUp
+            void siftDown
+
+   Author: Yao-li Chuang
+   ============================================================ */
+#include"EventQueueC.hpp"
+
+/***********************************************************
+  This subroutine sets the times of all events and builds
+    the heap from the bottom up, in O(n).
+  Input values:
+     $(t) gives the time of each event.
+ ***********************************************************/
+void eventQueue::assign(const vector<double> &t) {
+  int n = t.size();
+  time = t;
+  heap.resize(n);
+  pos.resize(n);
+  for(int h=0; h<n; h++) heap[h] = pos[h] = h;
+  for(int h=n/2-1; h>=0; h--) siftDown(h);
+}
+
+/***********************************************************
+  This subroutine changes the time of the event $(id) to $(t)
+    and moves the event up or down the heap accordingly.
+ ***********************************************************/
+void eventQueue::update(int id, double t) {
+  double t_old = time[id];
+  time[id] = t;
+  if(t < t_old) siftUp(pos[id]);
+  else siftDown(pos[id]);
+}
+
+/***********************************************************
+  These subroutines move the event at the position $(h) of
+    the heap up towards the root or down towards the leaves,
+    until the heap is in order again.
+ ***********************************************************/
+void eventQueue::siftUp(int h) {
+  int id = heap[h];
+  while(h > 0) {
+    int parent = (h-1)/2;
+    if(!before(id, heap[parent])) break;
+    heap[h] = heap[parent];
+    pos[heap[h]] = h;
+    h = parent;
+  } // end of while loop
+  heap[h] = id;
+  pos[id] = h;
+}
+
+void eventQueue::siftDown(int h) {
+  int n = heap.size();
+  int id = heap[h];
+  for(;;) {
+    int child = 2*h+1;
+    if(child >= n) break;
+    if(child+1 < n && before(heap[child+1], heap[child])) child++;
+    if(!before(heap[child], id)) break;
+    heap[h] = heap[child];
+    pos[heap[h]] = h;
+    h = child;
+  } // end of for loop
+  heap[h] = id;
+  pos[id] = h;
+}
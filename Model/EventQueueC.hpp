@@ -0,0 +1,57 @@
+/* ============================================================
+   Header file for the eventQueue class
+   -----
+   Brief Summary: An indexed priority queue of events, i.e., a
+                  binary min-heap of the times of the events
+                  0 to n-1, in which the time of any event can be
+                  changed in O(log n).
+   -----
+      variables --
+          time : time of each event (INFINITY: never occurs)
+          heap : the events, ordered as a binary heap by $(time)
+          pos : position of each event in $(heap)
+   -----
+      Events of the same time are ordered by their indices, so the
+        order in which the events occur is defined by their times
+        alone.
+   -----
+       Functions and subroutines not defined explicitly here are
+          defined in EventQueueC.cxx.
+
+   Author: Yao-li Chuang
+   ============================================================ */
+#ifndef __EventQueueC_hpp_INCLUDED__
+#define __EventQueueC_hpp_INCLUDED__
+
+#include"../CCommon.h"
+
+/**************************************************************
+   eventQueue class
+ **************************************************************/
+class eventQueue {
+
+public:
+  // Constructor & destructor
+  eventQueue(void) {}
+  ~eventQueue(void) {}
+  // Getters
+  int size(void) {return time.size();}
+  int top(void) {return heap[0];}             // the next event
+  double topTime(void) {return time[heap[0]];}
+  double getTime(int id) {return time[id];}
+  // Setters
+  void assign(const vector<double> &t); // all events at once
+  void update(int id, double t);        // one event
+
+private:
+  vector<double> time;
+  vector<int> heap, pos;
+  bool before(int a, int b) {
+    return time[a] < time[b] || (time[a] == time[b] && a < b);
+  }
+  void siftUp(int h);
+  void siftDown(int h);
+};
+
+
+#endif
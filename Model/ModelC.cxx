@@ -5,18 +5,39 @@
             void setDefaultParameters
 	    void resetParametersFromFile
 	    void changeParameter
+	    int isParameter
 	    double hostInitiation
             void nextTimeStep
 	    void createAdjMatrix
 	    void createUtMatrix
+	    int findLink
+	    void addLink
+	    void cutLink
+	    void insertLink
+	    double eraseLink
+	    void compactEdges
+	    int linkType
+	    void forEachRange
+	    void forEachNodeRange
 	    void updateUtMatrix
+	    void verifyUtMatrix
+	    void updateUtPrefix
+	    int samplePartner
 	    void updateOpinion
 	    void updateOpinion2
 	    void updateOpinionGuest
 	    void updateOpinion2Guest
 	    vector<double> utilityFunction
+	    void setUtilityConstants
+	    void setCostTable
+	    bool denseFits
 	    void evolveAdjMatrix
+	    int selectCandidate
+	    int evolveOneLink
+	    int decideLink
+	    void evolveAdjMatrixSync
 	    void updateConnection
+     (The event-driven engine run by nextTimeStep is in EventC.cxx.)
    -----
     Note:
        There are 2 mechanisms of updating the opinions.
@@ -32,9 +53,30 @@
           but change only the opinions of guests. Host opinions are
           fixed.
 
+       The adjacency and the utility "matrices" are stored sparsely:
+          adjList[i] holds the sorted indices of the partners of node i
+          and adjEdge[i] the slots of these links in the list of links
+          $(edges) (see ../Node/EdgeListC.hpp), which holds the 
+          utilities of both ends of every link. The memory and the
+          cost of a time step thus grow with the number of links
+          rather than with the square of the number of nodes.
+       The lists persist between time steps. Every added or cut link
+          goes through insertLink or eraseLink, which update both ends
+          of the link in the lists; addLink and cutLink also update the tallies $(link_count) 
+          and $(link_rw).
+
+       The opinion updates and evolveAdjMatrix run on the pool of
+          threads $(pool) if one is set. In the opinion updates, every
+          node reads only the opinions saved at time t and writes only
+          its own opinion, and updateOpinion2 draws the random number
+          of node i from the counter of node i. See evolveAdjMatrix for
+          how it keeps the order of the nodes. The results do not
+          depend on the number of threads.
+
    Author: Yao-li Chuang
    ============================================================ */
 #include"../Node/NodeListC.hpp"
+#include"../Parallel/ThreadPoolC.hpp"
 
 /***********************************************************
   This subroutine sets the values of the model parameters.
@@ -50,7 +92,15 @@ void nodeList::setDefaultParameters(void) {
   par.welfare = 0.0;
   par.enable_op = true;
   par.enable_net = true;
+  par.sync_net = false;
+  par.fast_exp = false;
+  par.event_driven = false;
+  par.ut_epsilon = 0.0;
+  par.ut_verify = false;
+  par.dense_mb = 1024.0;
   par.ini_hlink_frac = 0.9;
+  setUtilityConstants();
+  setCostTable(opinion.size());
 }
 
 /***********************************************************
@@ -58,8 +108,10 @@ void nodeList::setDefaultParameters(void) {
       from a text input file.
   Input values:
      $(file_name) specifies the name of the input file.
+     $(verbose) specifies whether the values are printed
+        in the terminal (default true).
  ***********************************************************/
-void nodeList::resetParametersFromFile(string file_name) {
+void nodeList::resetParametersFromFile(string file_name, bool verbose) {
   string line;
   ifstream input_file(file_name.data());
   if (input_file.is_open()) {
@@ -68,23 +120,34 @@ void nodeList::resetParametersFromFile(string file_name) {
       string pname;
       line_stream >> pname;
       if(   (pname.compare("enable_op")==0)
-	 || (pname.compare("enable_net")==0) ) {
+	 || (pname.compare("enable_net")==0)
+	 || (pname.compare("sync_net")==0)
+	 || (pname.compare("fast_exp")==0)
+	 || (pname.compare("event_driven")==0)
+	 || (pname.compare("ut_verify")==0) ) {
 	bool value;
 	line_stream >> value;
 	changeParameter(pname, value);
-	cout << "bool" << endl;
-	cout << pname.data() << " is " << value << endl;
+	if(verbose) {
+	  cout << "bool" << endl;
+	  cout << pname.data() << " is " << value << endl;
+	}
       } else if(   (pname.compare("n_node")==0)
 		|| (pname.compare("immigrant_number")==0) 
 		|| (pname.compare("immigrant_ratio")==0) 
 		|| (pname.compare("initial_connections")==0) 
-		|| (pname.compare("initial_opinions")==0) ) {
+		|| (pname.compare("initial_opinions")==0)
+		|| (pname.compare("checkpoint_file")==0)
+		|| (pname.compare("checkpoint_every")==0)
+		|| (pname.compare("frame_prefix")==0)
+		|| (pname.compare("frame_every")==0) ) {
 	// do nothing (parameters for initial conditions)
       } else {
 	double value;
 	line_stream >> value;
 	changeParameter(pname, value);
-	cout << pname.data() << " is " << value << endl;
+	if(verbose)
+	  cout << pname.data() << " is " << value << endl;
       } // end of if pname is some string statement
     } // end of getline from input_file loop
     input_file.close();
@@ -111,8 +174,10 @@ void nodeList::changeParameter(string pname, double value) {
   else if(pname.compare("sigmaG")==0) {
     par.sigmaG = value;
   }
-  else if(pname.compare("alpha")==0)
+  else if(pname.compare("alpha")==0) {
     par.alpha = value;
+    setCostTable(opinion.size());
+  }
   else if(pname.compare("gamma")==0)
     par.gamma = value;
   else if(pname.compare("kappa")==0)
@@ -121,10 +186,17 @@ void nodeList::changeParameter(string pname, double value) {
     par.welfare = value;
   else if(pname.compare("ini_hlink_frac")==0)
     par.ini_hlink_frac = value;
+  else if(pname.compare("dense_mb")==0)
+    par.dense_mb = value;
+  else if(pname.compare("ut_epsilon")==0)
+    par.ut_epsilon = value;
   else {
     cout << "no parameter called " << pname << endl;
     exit(1);
   }
+  setUtilityConstants();
+  ut_up2date = false; // the utilities may depend on the new value
+  op_ut.clear();      //   (recomputing all links)
 }
 
 /***********************************************************
@@ -138,10 +210,43 @@ void nodeList::changeParameter(string pname, bool value) {
     par.enable_op = value;
   else if(pname.compare("enable_net")==0)
     par.enable_net = value;
+  else if(pname.compare("sync_net")==0)
+    par.sync_net = value;
+  else if(pname.compare("fast_exp")==0) {
+    par.fast_exp = value;
+    ut_up2date = false; // the utilities change slightly
+    op_ut.clear();
+  }
+  else if(pname.compare("event_driven")==0)
+    par.event_driven = value;
+  else if(pname.compare("ut_verify")==0)
+    par.ut_verify = value;
   else {
     cout << "no parameter called " << pname << endl;
     exit(1);
   }
+  events_up2date = false; // the rates may depend on the new value
+}
+
+/***********************************************************
+  This function tells whether $(pname) is the name of a model
+    parameter that changeParameter accepts, e.g., to check the
+    names of the input before the simulation starts.
+  Return value:
+     1 for a real number parameter, 2 for a logical parameter,
+     and 0 if there is no parameter called $(pname).
+ ***********************************************************/
+int nodeList::isParameter(string pname) {
+  const char *real_name[] = {"AH", "AG", "sigmaH", "sigmaG", "alpha",
+			     "gamma", "kappa", "welfare", "ini_hlink_frac",
+			     "dense_mb", "ut_epsilon"};
+  const char *bool_name[] = {"enable_op", "enable_net", "sync_net",
+			     "fast_exp", "event_driven", "ut_verify"};
+  for(size_t k=0; k<sizeof(real_name)/sizeof(char *); k++)
+    if(pname.compare(real_name[k])==0) return 1;
+  for(size_t k=0; k<sizeof(bool_name)/sizeof(char *); k++)
+    if(pname.compare(bool_name[k])==0) return 2;
+  return 0;
 }
 
 /***********************************************************
@@ -159,12 +264,17 @@ double nodeList::hostInitiation(void) {
 
   createAdjMatrix();
   createUtMatrix();
+  setCostTable(opinion.size());
   for(int i=0; i<50; i++) {
+    time_step++; // a new counter of the random numbers
     updateUtMatrix();
-    evolveAdjMatrix();
+    if(par.sync_net)
+      evolveAdjMatrixSync();
+    else
+      evolveAdjMatrix();
   }
+  events_up2date = false;
   updateConnection();
-  adjMatrix.clear(); utMatrix.clear();
   setGuestsIdling(false);
 
   computeStats();
@@ -174,92 +284,466 @@ double nodeList::hostInitiation(void) {
 /******************************************************************
    This subroutine simulates the model and advances from time t 
       to the next time step t+1.
+   It involves no graphic computations, so it can run headless
+      (see Batch.cxx).
  ******************************************************************/
 void nodeList::nextTimeStep(void) {
-  createAdjMatrix();     // creating the adjacency matrix of time t
-  createUtMatrix();      // creating the utility matrix of time t
-  // If opinion change is enabled, calculate new opinions of time t+1
-  if(par.enable_op) {
-    //updateOpinion2Guest();
-    updateOpinion2();
-  }
-  updateUtMatrix();      // updating the utility matrix to time t+1
-  // If network remodeling is enabled, evolve the adjacency matrix
-  //    to time t+1
-  if(par.enable_net) {
-    evolveAdjMatrix();
-  }
-  updateConnection(); // updating the network connections with the new adjacency matrix
-  updateGraphData();  // updating the graphic agents for visual display
-  adjMatrix.clear(); utMatrix.clear(); // no further use of the adjacency and the utility matrices for this time step.
+  int n=opinion.size();
+  time_step++; // the random numbers of this step are keyed by time_step
+  if(cost_table.size() < opinion.size()+1) setCostTable(n); // n links at most
+  // The adjacency and the utility lists of time t are kept from the
+  //   previous step; they are only (re)created when missing or stale.
+  if(adjList.size()!=opinion.size() || adjEdge.size()!=opinion.size())
+    createUtMatrix();
+  else if(!ut_up2date)
+    updateUtMatrix();
+  if(par.event_driven) {
+    // Run the opinion updates and the link proposals as events over
+    //   one unit of time (see EventC.cxx)
+    runEvents(1.0);
+  } else {
+    events_up2date = false; // changes not made by the events
+    // If opinion change is enabled, calculate new opinions of time t+1
+    if(par.enable_op) {
+      //updateOpinion2Guest();
+      updateOpinion2();
+      ut_up2date = false;
+    }
+    if(!ut_up2date)
+      updateUtMatrix();      // updating the utility lists to time t+1
+    // If network remodeling is enabled, evolve the adjacency lists
+    //    to time t+1
+    if(par.enable_net) {
+      if(par.sync_net)
+	evolveAdjMatrixSync();
+      else
+	evolveAdjMatrix();
+    }
+  } // end of if-else (event_driven) statement
+  updateConnection(); // refreshing the utilities of the nodes and the statistics
+  // The graphic agents are not updated here; updateGraphData is called
+  //    only when a frame is drawn: by the graphic program when the
+  //    display asks for one (see model in Main.cxx), and by the batch
+  //    program every step while it makes a movie (see Batch.cxx).
 }
 
 /***********************************************************
-  This subroutine creates the adjacency matrix.
-    0: disconnected
-    1: connected
+  This subroutine sorts the adjacency lists made while the initial
+    network is built (see NodeListC.cxx), in which the links are
+    listed in the order they are made.
+    adjList[i] : sorted indices of the nodes linked with node i
   Moreover, the member vector $(num_link) is also updated, which
-    keeps track of the number of links each node currently has.
+    keeps track of the number of links each node currently has,
+    and so is the tally of links of each type $(link_count).
  ***********************************************************/
 void nodeList::createAdjMatrix(void) {
-  int n=memberNodes.size();
-  int m=n*n;
-  if(!adjMatrix.empty()) adjMatrix.clear();
-  if(!num_link.empty()) num_link.clear();
-  adjMatrix.assign(m, 0);
+  int n=opinion.size();
+  if(adjList.size()!=opinion.size()) {
+    cout << "Error in createAdjMatrix: wrong dimension of adjList" << endl;
+    exit(1);
+  }
   num_link.assign(n, 0);
+  for(int k=0; k<3; k++) link_count[k] = 0;
   for(int i=0; i<n; i++) {
-    for(int j=i+1; j<n; j++)
-      if(memberNodes[i].checkAConnection(memberNodes[j].getId()) != -1) {
-	adjMatrix[i*n + j] = 1;
-	adjMatrix[j*n + i] = 1;
-      }
-    num_link[i] = memberNodes[i].getNumConnections(); // updating num_link
+    sort(adjList[i].begin(), adjList[i].end()); // ascending partner index
+    // A pair may be listed twice (e.g., by setNeighborConnections, which
+    //   links each pair of neighbors from both ends); keep one entry.
+    adjList[i].erase(unique(adjList[i].begin(), adjList[i].end()),
+		     adjList[i].end());
+    num_link[i] = adjList[i].size(); // updating num_link
+    for(int k=0; k<num_link[i]; k++)
+      link_count[linkType(i, adjList[i][k])]++;
   }
+  dist_up2date = false;
 }
 
 /***********************************************************
-  This subroutine creates the utility matrix.
+  This subroutine creates the list of links $(edges) from the
+    adjacency lists, and the slots of the links adjEdge[i][k],
+    one per entry of the adjacency lists.
  ***********************************************************/
 void nodeList::createUtMatrix(void) {
-  int n=memberNodes.size();
-  int m=n*n;
-  if(adjMatrix.size()!=m || num_link.size() != n) createAdjMatrix();
-  if(!utMatrix.empty()) utMatrix.clear();
-  utMatrix.assign(m, 0.0);
+  int n=opinion.size();
+  if(num_link.size()!=opinion.size()) createAdjMatrix();
+  edges.clear();
+  adjEdge.clear();
+  adjEdge.resize(n);
+  for(int i=0; i<n; i++)
+    adjEdge[i].assign(adjList[i].size(), -1);
+  for(int i=0; i<n; i++)
+    for(size_t k=0; k<adjList[i].size(); k++) {
+      int j = adjList[i][k];
+      if(j<i) continue; // added already from node j
+      int ji = findLink(j, i);
+      if(ji == -1) {
+        // Print error messages if i is linked to j but not vice versa.
+	cout << "Error: adjList is not symmetric in createUtMatrix" << endl;
+	exit(1);
+      }
+      adjEdge[i][k] = adjEdge[j][ji] = edges.add(i, j, linkType(i, j), 0.0, 0.0,
+						     time_step);
+    } // end of i and k loops
+  op_ut.clear(); // the new links have no utilities yet
   updateUtMatrix();
 }
 
 /***********************************************************
-  This subroutine updates the utility matrix.
-     utMatrix[i][j] -> utility of node i received from node j
+  This function looks for node $(j) among the partners of
+    node $(i) by a binary search of the sorted adjList[i].
+  Return value:
+     the offset of $(j) in adjList[i] (and adjEdge[i]),
+     or -1 if $(i) and $(j) are not linked.
+ ***********************************************************/
+int nodeList::findLink(int i, int j) {
+  vector<int> &adj = adjList[i];
+  vector<int>::iterator it = lower_bound(adj.begin(), adj.end(), j);
+  if(it == adj.end() || *it != j) return -1;
+  return (it - adj.begin());
+}
+
+/***********************************************************
+  This subroutine adds a link between nodes $(i) and $(j), 
+    and updates the tallies of links and rewards.
+  Input values:
+     $(ut_ij) is the utility of node i given by node j.
+     $(ut_ji) is the utility of node j given by node i.
+ ***********************************************************/
+void nodeList::addLink(int i, int j, double ut_ij, double ut_ji) {
+  insertLink(i, j, ut_ij, ut_ji);
+  int ltype = linkType(i, j);
+  link_count[ltype] += 2;
+  link_rw[ltype] += ut_ij + ut_ji;
+  dist_up2date = false;
+}
+
+/***********************************************************
+  This subroutine removes the link between nodes $(i) and $(j),
+    and updates the tallies of links and rewards.
+ ***********************************************************/
+void nodeList::cutLink(int i, int j) {
+  int ltype = linkType(i, j);
+  link_count[ltype] -= 2;
+  link_rw[ltype] -= eraseLink(i, j);
+  dist_up2date = false;
+}
+
+/***********************************************************
+  This subroutine adds a link between nodes $(i) and $(j) to
+    the adjacency and the utility lists, keeping them sorted.
+  Only nodes i and j and the slot $(e) are changed (not the 
+    tallies), so links between different pairs of nodes can be
+    added in parallel, each with a slot reserved for it. The
+    running sums of the utilities are marked out of date.
+  Input values:
+     $(ut_ij) is the utility of node i given by node j.
+     $(ut_ji) is the utility of node j given by node i.
+     $(e) is the slot of $(edges) for the link (default -1: a new
+        slot at the end of $(edges), which is not thread-safe).
+ ***********************************************************/
+void nodeList::insertLink(int i, int j, double ut_ij, double ut_ji, int e) {
+  if(e == -1)
+    e = edges.add(i, j, linkType(i, j), ut_ij, ut_ji, time_step);
+  else
+    edges.set(e, i, j, linkType(i, j), ut_ij, ut_ji, time_step);
+  vector<int>::iterator it;
+  it = lower_bound(adjList[i].begin(), adjList[i].end(), j);
+  adjEdge[i].insert(adjEdge[i].begin()+(it-adjList[i].begin()), e);
+  adjList[i].insert(it, j);
+  it = lower_bound(adjList[j].begin(), adjList[j].end(), i);
+  adjEdge[j].insert(adjEdge[j].begin()+(it-adjList[j].begin()), e);
+  adjList[j].insert(it, i);
+  num_link.at(i)++;                // num_link increases by 1
+  num_link.at(j)++;
+  prefix_up2date = false;
+}
+
+/***********************************************************
+  This function removes the link between nodes $(i) and $(j)
+    from the adjacency and the utility lists.
+  Like insertLink, only nodes i and j and the slot of the link
+    are changed; the slot is freed, to be reused after compactEdges,
+    and the running sums of the utilities are marked out of date.
+  Return value: the rewards of the link removed (the sum of
+    the utilities of both ends)
+ ***********************************************************/
+double nodeList::eraseLink(int i, int j) {
+  int ij = findLink(i, j), ji = findLink(j, i);
+  if(ij == -1 || ji == -1) {
+    cout << "Error in eraseLink: nodes " << i << " and " << j << " are not linked." << endl;
+    exit(1);
+  }
+  double rw = linkUtility(i, ij) + linkUtility(j, ji);
+  edges.remove(adjEdge[i][ij]);
+  adjList[i].erase(adjList[i].begin()+ij);
+  adjEdge[i].erase(adjEdge[i].begin()+ij);
+  adjList[j].erase(adjList[j].begin()+ji);
+  adjEdge[j].erase(adjEdge[j].begin()+ji);
+  num_link.at(i)--;               // num_link decreases by 1
+  num_link.at(j)--;
+  prefix_up2date = false;
+  return rw;
+}
+
+/***********************************************************
+  This subroutine fills the free slots of $(edges) left by
+    eraseLink (and by slots reserved but not used) with the links
+    at the end, and updates the slots in adjEdge of the moved
+    links accordingly.
+  The slots of the links change, so the running sums of the
+    utilities $(ut_prefix) are marked out-of-date as well.
+ ***********************************************************/
+void nodeList::compactEdges(void) {
+  prefix_up2date = false;
+  vector<int> moved;
+  edges.compact(moved);
+  for(size_t m=0; m<moved.size(); m++) {
+    int e = moved[m];
+    int i = edges.getLo(e), j = edges.getHi(e);
+    adjEdge[i][findLink(i, j)] = e;
+    adjEdge[j][findLink(j, i)] = e;
+  } // end of m loop
+}
+
+/***********************************************************
+  This function returns the type of the link between nodes
+    $(i) and $(j), used as the index of $(link_count) and
+    $(link_rw).
+    0: host-host, 1: host-guest, 2: guest-guest
+ ***********************************************************/
+int nodeList::linkType(int i, int j) {
+  return (node_type[i]==1 ? 0 : 1) + (node_type[j]==1 ? 0 : 1);
+}
+
+/***********************************************************
+  This subroutine runs $(body)(first, last) over the ranges
+    [first, last) that together cover the items 0 to n_item-1.
+  Without a pool of threads, or with too few items to be worth
+    splitting, it runs $(body)(0, n_item) once. Otherwise, the
+    items are split into ranges of about equal size, up to 4 per
+    thread, which run as tasks on the pool.
+ ***********************************************************/
+void nodeList::forEachRange(int n_item, function<void(int, int)> body) {
+  const int min_range = 128; // fewest items per task
+  int n_range = (pool==NULL) ? 1 : 4*pool->getNumThreads();
+  if(n_range > n_item/min_range) n_range = n_item/min_range;
+  if(n_range <= 1) {
+    body(0, n_item);
+    return;
+  }
+
+  taskGroup group;
+  for(int r=0; r<n_range; r++) {
+    int first = static_cast<long int>(n_item)*r/n_range;
+    int last = static_cast<long int>(n_item)*(r+1)/n_range;
+    pool->submit([&body, first, last]() { body(first, last); }, group);
+  } // end of r loop
+  pool->wait(group);
+}
+
+/***********************************************************
+  This subroutine runs $(body)(first, last) over the node ranges
+    [first, last) that together cover all nodes.
+  Without a pool of threads, it runs $(body)(0, n) once.
+  With a pool, the nodes are split into 4 ranges per thread with
+    about the same number of links plus nodes in each, since the
+    work of a node grows with its number of links, and the ranges
+    run as tasks on the pool. It returns when all ranges are done.
+  -----
+  $(body) may write only to the nodes of its own range.
+ ***********************************************************/
+void nodeList::forEachNodeRange(function<void(int, int)> body) {
+  int n=opinion.size();
+  int n_range = (pool==NULL) ? 1 : 4*pool->getNumThreads();
+  if(n_range <= 1 || n < 2*n_range) { // not worth splitting
+    body(0, n);
+    return;
+  }
+
+  // Split the nodes at equal shares of the total work.
+  long int total=0, acc=0;
+  for(int i=0; i<n; i++)
+    total += num_link[i] + 1;
+  vector<int> bound(1, 0);
+  for(int i=0; i<n; i++) {
+    acc += num_link[i] + 1;
+    if(acc*n_range >= total*(long int)bound.size() && i+1 < n)
+      bound.push_back(i+1);
+  } // end of i loop
+  bound.push_back(n);
+
+  taskGroup group;
+  for(size_t r=0; r+1<bound.size(); r++) {
+    int first=bound[r], last=bound[r+1];
+    pool->submit([&body, first, last]() { body(first, last); }, group);
+  } // end of r loop
+  pool->wait(group);
+}
+
+/***********************************************************
+  This subroutine updates the utilities of the links in $(edges)
+    from the current opinions, split among the pool of threads if
+    there is one.
+  Only the links of the dirty nodes are recomputed, i.e., those
+    whose opinions have moved by more than $(par.ut_epsilon) from
+    the opinions $(op_ut) of their last recomputation, unless
+    these links are a large part of all links or the constants of
+    the utility function have changed ($(op_ut) is cleared). All
+    links are then recomputed in one pass over the slots (see
+    updateUtilities in ../Node/EdgeListC.cxx).
+  With $(par.ut_verify), the result is checked against the full
+    recomputation (see verifyUtMatrix).
+  The rewards of the links of each type $(link_rw) are recounted.
  ***********************************************************/
 void nodeList::updateUtMatrix(void) {
-  int n=memberNodes.size();
-  int m=n*n;
-  if(utMatrix.size()!=m) createUtMatrix();
+  int n=opinion.size();
+  if(adjEdge.size()!=opinion.size()) {
+    createUtMatrix(); // which calls updateUtMatrix again
+    return;
+  }
+
+  bool full = (op_ut.size()!=opinion.size());
+  if(!full) {
+    // Mark the dirty nodes, and count the links to recompute.
+    op_dirty.assign(n, 0);
+    long int n_incident = 0;
+    for(int i=0; i<n; i++)
+      if(fabs(opinion[i] - op_ut[i]) > par.ut_epsilon) {
+	op_dirty[i] = 1;
+	n_incident += num_link[i];
+      } // end of i loop and if (node i dirty) statement
+    // A pass over all slots is faster than visiting the links
+    //   one by one if they are more than 1/8 of the slots.
+    full = (8*n_incident > edges.getNumSlots());
+  }
+  if(full) {
+    forEachRange(edges.getNumSlots(), [&](int first, int last) {
+      edges.updateUtilities(first, last, opinion.data(), ec, par.fast_exp);
+    });
+    op_ut = opinion;
+  } else {
+    // the slots of the links of the dirty nodes, each link once
+    dirty_slots.clear();
+    for(int i=0; i<n; i++)
+      if(op_dirty[i]) {
+	for(int k=0; k<num_link[i]; k++) {
+	  int j = adjList[i][k];
+	  if(!op_dirty[j] || j > i) dirty_slots.push_back(adjEdge[i][k]);
+	} // end of k loop
+	op_ut[i] = opinion[i];
+      } // end of i loop and if (node i dirty) statement
+    forEachRange(dirty_slots.size(), [&](int first, int last) {
+      edges.updateSlots(dirty_slots.data()+first, last-first, opinion.data(),
+			ec, par.fast_exp);
+    });
+  } // end of if-else (full) statement
+  if(par.ut_verify) verifyUtMatrix();
+  edges.sumRewards(link_rw);
+  ut_up2date = true;
+  prefix_up2date = false;
+  events_up2date = false;
+}
+
+/***********************************************************
+  This subroutine checks the utilities of the links against a
+    full recomputation from the current opinions (the verification
+    mode of updateUtMatrix, $(par.ut_verify)).
+  With $(par.ut_epsilon) = 0, any difference is an error.
+    Otherwise, the largest difference is printed.
+  The utilities are left as they were, so that the verification
+    does not change the simulation.
+ ***********************************************************/
+void nodeList::verifyUtMatrix(void) {
+  int m = edges.getNumSlots();
+  vector<double> ut_lo(m), ut_hi(m);
+  for(int e=0; e<m; e++) {
+    ut_lo[e] = edges.getUtility(e, edges.getLo(e));
+    ut_hi[e] = edges.getUtility(e, edges.getHi(e));
+  } // end of e loop
+  forEachRange(m, [&](int first, int last) {
+    edges.updateUtilities(first, last, opinion.data(), ec, par.fast_exp);
+  });
+  double max_diff = 0.0;
+  int e_max = -1;
+  for(int e=0; e<m; e++) {
+    if(edges.getTag(e) == EDGE_FREE) continue;
+    int i = edges.getLo(e), j = edges.getHi(e);
+    double diff = max(fabs(ut_lo[e] - edges.getUtility(e, i)),
+		      fabs(ut_hi[e] - edges.getUtility(e, j)));
+    if(diff > max_diff) {
+      max_diff = diff;
+      e_max = e;
+    }
+    edges.setUtilities(e, i, ut_lo[e], ut_hi[e]);
+  } // end of e loop
+  if(e_max == -1) return;
+  if(par.ut_epsilon == 0.0) {
+    cout << "Error in verifyUtMatrix: the utilities of the link between nodes "
+	 << edges.getLo(e_max) << " and " << edges.getHi(e_max)
+	 << " differ from the full recomputation by " << max_diff << endl;
+    exit(1);
+  }
+  cout << "verifyUtMatrix: at time step " << time_step
+       << ", the utilities differ from the full recomputation by up to "
+       << max_diff << " (ut_epsilon " << par.ut_epsilon << ")" << endl;
+}
 
+/***********************************************************
+  This subroutine computes the running sums of the utilities of
+    the links of every node $(ut_prefix), in the order of adjList,
+    from which samplePartner draws a partner. The sums are laid 
+    out one node after another in one array, which is reused from
+    step to step.
+  The sums are made again after the utilities are updated or the
+    links are changed (updateUtMatrix and compactEdges clear
+    $(prefix_up2date)), which costs one pass over the links.
+ ***********************************************************/
+void nodeList::updateUtPrefix(void) {
+  int n=opinion.size();
+  prefix_start.resize(n+1);
+  prefix_start[0] = 0;
   for(int i=0; i<n; i++)
-    for(int j=i+1; j<n; j++) {
-      int ij = i*n + j;
-      int ji = j*n + i;
-      if(adjMatrix.at(ij)==1) {
-	if(adjMatrix.at(ji) != 1) {
-          // Print error messages if i is linked to j but not vice versa.
-	  cout << "Error: adjMatrix is not symmetric in createUtMatrix" << endl;
-	  exit(1);
-	}
-	vector<double> ut_tmp = utilityFunction( memberNodes[i].getNodeType(),
-						 memberNodes[i].getOpinion(),
-						 memberNodes[j].getNodeType(),
-						 memberNodes[j].getOpinion() );
-	utMatrix.at(ij) = ut_tmp[0]; // utility of node i given by node j
-	utMatrix.at(ji) = ut_tmp[1]; // utility of node j given by node i
-      } else {
-	utMatrix.at(ij) = 0.0;
-	utMatrix.at(ji) = 0.0;
-      } // end of if (adjMatrix element == 1) statement
-    } // end of i,j loop
+    prefix_start[i+1] = prefix_start[i] + num_link[i];
+  ut_prefix.resize(prefix_start[n]);
+  forEachNodeRange([&](int first, int last) {
+    for(int i=first; i<last; i++) {
+      double acc_ut = 0.0;
+      double *prefix = &ut_prefix[prefix_start[i]];
+      for(int k=0; k<num_link[i]; k++) {
+	acc_ut += linkUtility(i, k);
+	prefix[k] = acc_ut;
+      } // end of k loop
+    } // end of i loop
+  }); // end of forEachNodeRange
+  prefix_up2date = true;
+}
+
+/***********************************************************
+  This function draws a partner of node $(i) with a probability
+    proportional to the utility it gives node i, by a binary
+    search of the running sums $(ut_prefix).
+  The welfare $(par.welfare) counts as one more share of the
+    total, in which case no partner is drawn.
+  Input values:
+     $(u) is a uniform random number in [0, 1).
+  Return value: the offset of the partner in adjList[i], i.e.,
+     the first k with u <= (sum of utilities 0..k)/total,
+     or -1 if there is none (the welfare share or no links).
+  -----
+  Note: The running sums increase with k, so this gives the same
+        partner as checking k = 0, 1, ... in turn.
+ ***********************************************************/
+int nodeList::samplePartner(int i, double u) {
+  int nlinki = num_link[i];
+  if(nlinki == 0) return -1;
+  const double *prefix = &ut_prefix[prefix_start[i]];
+  double tut = prefix[nlinki-1] + par.welfare; // total with welfare
+  int lo = 0, hi = nlinki; // the partner is in [lo, hi), or hi=nlinki if none
+  while(lo < hi) {
+    int mid = (lo + hi)/2;
+    if(u <= prefix[mid]/tut) hi = mid;
+    else lo = mid+1;
+  } // end of binary search
+  return (lo < nlinki) ? lo : -1;
 }
 
 /***********************************************************
@@ -271,31 +755,30 @@ void nodeList::updateUtMatrix(void) {
      influence.)
  ***********************************************************/
 void nodeList::updateOpinion(void) {
-  int n=memberNodes.size();
-  int m=n*n;
-  if(adjMatrix.size() != m || utMatrix.size()!=m) createUtMatrix();
+  if(adjList.size()!=opinion.size() || adjEdge.size()!=opinion.size())
+    createUtMatrix();
 
   // Save opinions of all nodes at the current time t.
-  vector<double> op_old;
-  for(int i=0; i<n; i++)
-    op_old.push_back(memberNodes[i].getOpinion());
+  vector<double> op_old(opinion);
 
-  for(int i=0; i<n; i++)
-    if(num_link.at(i)!=0) {
-      double result = 0.0, tut=0.0;
-      int ntype = memberNodes[i].getNodeType();
-      for(int j=0; j<n; j++) {
-	if(adjMatrix[i*n + j]==0) continue;
-	double tmp_ut = utMatrix[i*n + j];
-	result += tmp_ut * op_old[j];   // forward Euler
-	tut += tmp_ut;
-      } // end of j loop
-      result = ((par.kappa+par.welfare)*op_old[i]+result)/((par.kappa+par.welfare)+tut); // new opinion
-      // set the result to 0 if the new opinion goes to the other side
-      if((ntype==1 && result<0) || (ntype==-1 && result>0))
-	result = 0;
-      memberNodes[i].setOpinion(result);
-    } // end of i loop and if (num_link[i] not zero) statement
+  forEachNodeRange([&](int first, int last) {
+    for(int i=first; i<last; i++)
+      if(num_link.at(i)!=0) {
+	double result = 0.0, tut=0.0;
+	int ntype = node_type[i];
+	int nlinki = adjList[i].size();
+	for(int k=0; k<nlinki; k++) {
+	  double tmp_ut = linkUtility(i, k);
+	  result += tmp_ut * op_old[adjList[i][k]];   // forward Euler
+	  tut += tmp_ut;
+	} // end of k loop
+	result = ((par.kappa+par.welfare)*op_old[i]+result)/((par.kappa+par.welfare)+tut); // new opinion
+	// set the result to 0 if the new opinion goes to the other side
+	if((ntype==1 && result<0) || (ntype==-1 && result>0))
+	  result = 0;
+	opinion[i] = result;
+      } // end of i loop and if (num_link[i] not zero) statement
+  }); // end of forEachNodeRange
 }
 
 /***********************************************************
@@ -307,33 +790,32 @@ void nodeList::updateOpinion(void) {
      influence.)
  ***********************************************************/
 void nodeList::updateOpinionGuest(void) {
-  int n=memberNodes.size();
-  int m=n*n;
-  if(adjMatrix.size() != m || utMatrix.size()!=m) createUtMatrix();
+  if(adjList.size()!=opinion.size() || adjEdge.size()!=opinion.size())
+    createUtMatrix();
 
   // Save opinions of all nodes at the current time t.
-  vector<double> op_old;
-  for(int i=0; i<n; i++)
-    op_old.push_back(memberNodes[i].getOpinion());
+  vector<double> op_old(opinion);
 
-  for(int i=0; i<n; i++) {
-    int ntype = memberNodes[i].getNodeType();
-    if(ntype == 1) continue; // skipping the host nodes
-    if(num_link.at(i)!=0) {
-      double result = 0.0, tut=0.0;
-      for(int j=0; j<n; j++) {
-	if(adjMatrix[i*n + j]==0) continue;
-	double tmp_ut = utMatrix[i*n + j];
-	result += tmp_ut * op_old[j];   // forward Euler
-	tut += tmp_ut;
-      } // end of j loop
-      result = ((par.kappa+par.welfare)*op_old[i]+result)/((par.kappa+par.welfare)+tut); // new opinion
-      // set the result to 0 if the new opinion goes to the other side
-      if((ntype==1 && result<0) || (ntype==-1 && result>0))
-	result = 0;
-      memberNodes[i].setOpinion(result);
-    } // end of if (num_link[i] not zero) statement
-  } // end of i loop
+  forEachNodeRange([&](int first, int last) {
+    for(int i=first; i<last; i++) {
+      int ntype = node_type[i];
+      if(ntype == 1) continue; // skipping the host nodes
+      if(num_link.at(i)!=0) {
+	double result = 0.0, tut=0.0;
+	int nlinki = adjList[i].size();
+	for(int k=0; k<nlinki; k++) {
+	  double tmp_ut = linkUtility(i, k);
+	  result += tmp_ut * op_old[adjList[i][k]];   // forward Euler
+	  tut += tmp_ut;
+	} // end of k loop
+	result = ((par.kappa+par.welfare)*op_old[i]+result)/((par.kappa+par.welfare)+tut); // new opinion
+	// set the result to 0 if the new opinion goes to the other side
+	if((ntype==1 && result<0) || (ntype==-1 && result>0))
+	  result = 0;
+	opinion[i] = result;
+      } // end of if (num_link[i] not zero) statement
+    } // end of i loop
+  }); // end of forEachNodeRange
 }
 
 /***********************************************************
@@ -344,56 +826,38 @@ void nodeList::updateOpinionGuest(void) {
      these connected partners.
  ***********************************************************/
 void nodeList::updateOpinion2(void) {
-  int n=memberNodes.size();
-  int m=n*n;
-  if(adjMatrix.size() != m || utMatrix.size()!=m) createUtMatrix();
+  if(adjList.size()!=opinion.size() || adjEdge.size()!=opinion.size())
+    createUtMatrix();
 
   // Save opinions of all nodes at the current time t.
-  vector<double> op_old;
-  for(int i=0; i<n; i++)
-    op_old.push_back(memberNodes[i].getOpinion());
+  vector<double> op_old(opinion);
 
-  for(int i=0; i<n; i++)
-    if(num_link.at(i)!=0) { // if node i has at least 1 connection
-      vector<double> link_op, link_ut;
-      double tut=0.0;
-      int ntype = memberNodes[i].getNodeType();
-      for(int j=0; j<n; j++) {
-	if(adjMatrix[i*n + j]==0) continue; // skipping the nodes not connected with node i
-	double tmp_ut = utMatrix[i*n + j]; // utility of i given by j
-	link_ut.push_back(tmp_ut); // save the utility to array $(link_ut)
-	link_op.push_back(op_old[j]); // save the opinion of j to array
-	tut += tmp_ut; // add utility to the total utility of i
-      } // end of j loop
-      tut += par.welfare; // add welfare contribution
-
-      /* ==========
-         If node i has at least 1 link, the opinion of node i will 
-           shift towards one connected node randomly picked 
-           by a probability proportional to the utility it gives node i.
-         (In other words, those who generate more utility are more likely
-           to influence the opinions of others.)
-	  =========== */
-      int link_num = link_op.size();
-      if(link_num!=0) {
-	double tmp = static_cast<double>(rand())
-	  /static_cast<double>(RAND_MAX);
-	double acc_ut=0.0;
-	double ori_op = par.kappa*op_old[i];
-	for(int j=0; j<link_num; j++) {
-	  double result = ori_op;
-	  acc_ut += link_ut.at(j);
-	  if(tmp<=(acc_ut/tut)) {
-	    result = (result+link_op.at(j))/(par.kappa+1.0); // new opinion
-	   // set the result to 0 if the new opinion goes to the other side
-	    if((ntype==1 && result<0) || (ntype==-1 && result>0))
-	      result = 0;
-	    memberNodes[i].setOpinion(result);
-	    break;
-	  } // end of randomly selecting a neighbor
-	} // end of j loop among linked neighbors
-      } // end of if (link_num != 0) statement
-    } // end of i loop and if (num_link[i] not zero) statement
+  if(!prefix_up2date) updateUtPrefix(); // running sums of the utilities
+  vector<double> u(opinion.size()); // a random number per node
+  forEachNodeRange([&](int first, int last) {
+    rng.fillUniform(time_step, RNG_OPINION, 0, first, last-first, &u[first]);
+    for(int i=first; i<last; i++)
+      if(num_link.at(i)!=0) { // if node i has at least 1 connection
+	int ntype = node_type[i];
+	/* ==========
+	   If node i has at least 1 link, the opinion of node i will 
+	     shift towards one connected node randomly picked 
+	     by a probability proportional to the utility it gives node i,
+	     out of the total utility plus the welfare contribution.
+	   (In other words, those who generate more utility are more likely
+	     to influence the opinions of others.)
+	    =========== */
+	int k = samplePartner(i, u[i]); // u[i]: random number of node i // offset of the partner, or -1
+	if(k != -1) {
+	  double result = par.kappa*op_old[i];
+	  result = (result+op_old[adjList[i][k]])/(par.kappa+1.0); // new opinion
+	  // set the result to 0 if the new opinion goes to the other side
+	  if((ntype==1 && result<0) || (ntype==-1 && result>0))
+	    result = 0;
+	  opinion[i] = result;
+	} // end of if (a partner is selected) statement
+      } // end of i loop and if (num_link[i] not zero) statement
+  }); // end of forEachNodeRange
 }
 
 /***********************************************************
@@ -404,58 +868,40 @@ void nodeList::updateOpinion2(void) {
      these connected partners.
  ***********************************************************/
 void nodeList::updateOpinion2Guest(void) {
-  int n=memberNodes.size();
-  int m=n*n;
-  if(adjMatrix.size() != m || utMatrix.size()!=m) createUtMatrix();
+  if(adjList.size()!=opinion.size() || adjEdge.size()!=opinion.size())
+    createUtMatrix();
 
   // Save opinions of all nodes at the current time t.
-  vector<double> op_old;
-  for(int i=0; i<n; i++)
-    op_old.push_back(memberNodes[i].getOpinion());
+  vector<double> op_old(opinion);
 
-  for(int i=0; i<n; i++) {
-    int ntype = memberNodes[i].getNodeType();
-    if(ntype==1) continue; // skipping the host nodes
-    if(num_link.at(i)!=0) { // if guest node i has at least 1 connection
-      vector<double> link_op, link_ut;
-      double tut=0.0;
-      for(int j=0; j<n; j++) {
-	if(adjMatrix[i*n + j]==0) continue; // skipping the nodes not connected with node i
-	double tmp_ut = utMatrix[i*n + j]; // utility of i given by j
-	link_ut.push_back(tmp_ut); // save the utility to array $(link_ut)
-	link_op.push_back(op_old[j]); // save the opinion of j to array
-	tut += tmp_ut; // add utility to the total utility of i
-      } // end of j loop
-      tut += par.welfare; // add the contribution of welfare
-
-      /* =====
-         If node i has at least 1 link, the opinion of node i will 
-           shift towards one connected node randomly picked 
-           by a probability proportional to the utility it gives node i.
-         (In other words, those who generate more utility are more likely
-           to influence the opinions of others.)
-	 ===== */
-      int link_num = link_op.size();
-      if(link_num!=0) {
-	double tmp = static_cast<double>(rand())
-	  /static_cast<double>(RAND_MAX);
-	double acc_ut=0.0;
-	double ori_op = par.kappa*op_old[i];
-	for(int j=0; j<link_num; j++) {
-	  double result = ori_op;
-	  acc_ut += link_ut.at(j);
-	  if(tmp<=(acc_ut/tut)) {
-	    result = (result+link_op.at(j))/(par.kappa+1.0); // new opinion
-	   // set the result to 0 if the new opinion goes to the other side
-	    if((ntype==1 && result<0) || (ntype==-1 && result>0))
-	      result = 0;
-	    memberNodes[i].setOpinion(result);
-	    break;
-	  } // end of randomly selecting a neighbor
-	} // end of j loop among linked neighbors
-      } // end of if (link_num != 0) statement
-    } // end of if (num_link[i] not zero) statement
-  } // end of i loop
+  if(!prefix_up2date) updateUtPrefix(); // running sums of the utilities
+  vector<double> u(opinion.size()); // a random number per node
+  forEachNodeRange([&](int first, int last) {
+    rng.fillUniform(time_step, RNG_OPINION, 0, first, last-first, &u[first]);
+    for(int i=first; i<last; i++) {
+      int ntype = node_type[i];
+      if(ntype==1) continue; // skipping the host nodes
+      if(num_link.at(i)!=0) { // if guest node i has at least 1 connection
+	/* =====
+	   If node i has at least 1 link, the opinion of node i will 
+	     shift towards one connected node randomly picked 
+	     by a probability proportional to the utility it gives node i,
+	     out of the total utility plus the contribution of welfare.
+	   (In other words, those who generate more utility are more likely
+	     to influence the opinions of others.)
+	   ===== */
+	int k = samplePartner(i, u[i]); // u[i]: random number of node i // offset of the partner, or -1
+	if(k != -1) {
+	  double result = par.kappa*op_old[i];
+	  result = (result+op_old[adjList[i][k]])/(par.kappa+1.0); // new opinion
+	  // set the result to 0 if the new opinion goes to the other side
+	  if((ntype==1 && result<0) || (ntype==-1 && result>0))
+	    result = 0;
+	  opinion[i] = result;
+	} // end of if (a partner is selected) statement
+      } // end of if (num_link[i] not zero) statement
+    } // end of i loop
+  }); // end of forEachNodeRange
 }
 
 /******************************************************************
@@ -474,44 +920,78 @@ void nodeList::updateOpinion2Guest(void) {
     by each connection. 
   The cost incurrs at each node for maintaining a number of connections
     and will be calcualted separately.
+  ------
+  This function is kept for compatibility. The model itself uses the
+    kernels utilityHH, utilityHG, and utilityGG (see NodeListC.hpp),
+    which this function calls, or utilityPair for two given nodes.
  ******************************************************************/
 vector<double> nodeList::utilityFunction(int ntype1, double x1,
 					 int ntype2, double x2) {
-  vector<double> ut, A, sigma2;
-  // Setting the values of the model parameters A and sigma2, 
-  //     according to the node types
-  if(ntype2 == ntype1) {
-    A.push_back(par.AH);
-    A.push_back(par.AH);
-  } else {
-    A.push_back(par.AG);
-    A.push_back(par.AG);
-  }
-
-  if(ntype1 == 1)
-    sigma2.push_back(2.0*par.sigmaH);
+  vector<double> ut(2);
+  if(ntype1 == ntype2)
+    ut[0] = ut[1] = (ntype1 == 1) ? utilityHH(x1, x2) : utilityGG(x1, x2);
+  else if(ntype1 == 1)
+    utilityHG(x1, x2, ut[0], ut[1]);
   else
-    sigma2.push_back(2.0*par.sigmaG);
-
-  if(ntype2 == 1)
-    sigma2.push_back(2.0*par.sigmaH);
-  else
-    sigma2.push_back(2.0*par.sigmaG);
-
-  // Computing utility
-  double diff = x1 - x2;
-  for(int i=0; i<2; i++) {
-    double tmp = A[i] * exp( - (diff*diff/sigma2[i]) );
-    ut.push_back(tmp);
-    if(ntype1 == ntype2) {
-      ut.push_back(tmp);
-      break;
-    }
-  }
+    utilityHG(x2, x1, ut[1], ut[0]);
   // ut[0] is the utility of node 1, while ut[1] is the utility of node 2
   return(ut);
 }
 
+/******************************************************************
+  This subroutine tabulates the cost of maintaining links,
+    cost_table[k] = exp(k/alpha) for k = 0 to $(max_link), so that
+    linkCost (see NodeListC.hpp) needs no exp for the degrees 
+    of the nodes. It is called when alpha is set and when the
+    number of nodes outgrows the table.
+ ******************************************************************/
+void nodeList::setCostTable(int max_link) {
+  cost_table.resize(max_link+1);
+  for(int k=0; k<=max_link; k++)
+    cost_table[k] = exp(k/par.alpha);
+}
+
+/******************************************************************
+  This function checks whether a dense matrix of $(n_entry) entries
+    of $(entry_size) bytes each fits in the memory budget
+    $(par.dense_mb) (in MB). The n x n matrix distMatrix is only
+    made when it does, so that large populations run with the
+    sparse lists alone.
+  Input values:
+     $(name) names the matrix in the message.
+  Return value: true if the matrix fits; otherwise false, with a
+    message in the terminal.
+ ******************************************************************/
+bool nodeList::denseFits(string name, size_t n_entry, size_t entry_size) {
+  double mb = static_cast<double>(n_entry)*entry_size/(1024.0*1024.0);
+  if(mb <= par.dense_mb) return true;
+  cout << "Warning: the " << name << " of " << opinion.size() << " nodes needs "
+       << mb << " MB, more than dense_mb = " << par.dense_mb
+       << " MB; it is not computed." << endl;
+  return false;
+}
+
+/******************************************************************
+  This subroutine computes the constants of the utility function
+    from the model parameters. It is called whenever a parameter
+    value is set.
+ ******************************************************************/
+void nodeList::setUtilityConstants(void) {
+  utc.A_same = par.AH;
+  utc.A_cross = par.AG;
+  utc.inv_h = 1.0/(2.0*par.sigmaH);
+  utc.inv_g = 1.0/(2.0*par.sigmaG);
+  // the same constants by the tag of the links in $(edges)
+  double A[4] = {utc.A_same, utc.A_cross, utc.A_same, 0.0};
+  double inv_lo[4] = {utc.inv_h, utc.inv_h, utc.inv_g, 0.0};
+  double inv_hi[4] = {utc.inv_h, utc.inv_g, utc.inv_g, 0.0};
+  for(int t=0; t<4; t++) {
+    ec.A[t] = A[t];
+    ec.inv_lo[t] = inv_lo[t];
+    ec.inv_hi[t] = inv_hi[t];
+  }
+}
+
 /******************************************************************
   This subroutine evolves the adjacency matrix. 
   Here every node either adds a new edge or cuts an existing edge.
@@ -521,175 +1001,273 @@ vector<double> nodeList::utilityFunction(int ntype1, double x1,
     for deletion, where the probability of selection depends on
     the utility each edge is providing.
   -----
-  Note: The current version changes only the adjacency matrix at the
-        nodeList level but not the list of connections at the node level.
-        the subroutine updateConnection should be called immediately
-        to ensure that the list of connections is consistent with
-        the new adjacency matrix.
+  Note: The links are added or cut through insertLink and eraseLink, 
+        which update the lists of connections of both nodes in place,
+        so the durations of the other connections are kept.
   -----
-  To do in the future: It is better to also update the connection list
-                       of the node here in this subroutine, instead of
-                       having to call updateConnection.
+  The nodes are visited in the order of their indices, and each node
+    sees the links changed by the nodes before it. This is kept when
+    running on the pool of threads $(pool) as follows.
+     1. The candidate j of every node i is selected (in parallel).
+        It depends only on the random numbers of node i and on which
+        nodes are idling, not on the links.
+     2. The decision of node i reads and changes only the links of
+        nodes i and j. It is put in the round after the last round
+        that involved node i or node j, so the decisions in the same
+        round involve different nodes and run in parallel, while the
+        decisions sharing a node run in the order of their indices.
+     3. The tallies $(link_count) and $(link_rw) are updated in the
+        order of the node indices, so the results are the same as
+        without the pool.
+  A link added by node i takes the slot of $(edges) reserved for
+    node i; the slots left free are filled by compactEdges at the
+    end.
  ******************************************************************/
 void nodeList::evolveAdjMatrix(void) {
-  int n=memberNodes.size();
-  int m=n*n;
-  // If something has a wrong size, recreate utility matrix,
-  //   which will also correct num_link and adjMatrix
-  if(num_link.size() != n || adjMatrix.size() != m
-     || utMatrix.size()!=m) createUtMatrix();
+  int n=opinion.size();
+  // If something has a wrong size, recreate the utility lists,
+  //   which will also correct num_link and adjList
+  if(num_link.size()!=opinion.size() || adjList.size()!=opinion.size()
+     || adjEdge.size()!=opinion.size()) createUtMatrix();
+
+  // Select the candidate of each node (-1 for idling nodes)
+  vector<int> cand(n);
+  forEachRange(n, [&](int first, int last) {
+    for(int i=first; i<last; i++)
+      cand[i] = selectCandidate(i);
+  });
+
+  vector<int> change(n, 0);    // +1: link added, -1: link cut, 0: none
+  vector<double> d_rw(n, 0.0); // change of the rewards of the link
+  int slot0 = edges.getNumSlots(); // slot of node i: slot0+i
+  edges.reserve(n);
+  if(pool == NULL) {
+    for(int i=0; i<n; i++)
+      if(cand[i] != -1)
+	change[i] = evolveOneLink(i, cand[i], d_rw[i], slot0+i);
+  } else {
+    // Put the decision of each node in a round.
+    vector<int> last_round(n, 0), round(n, 0);
+    int n_round = 0;
+    for(int i=0; i<n; i++) {
+      int j = cand[i];
+      if(j == -1) continue;
+      int r = 1 + max(last_round[i], last_round[j]);
+      round[i] = last_round[i] = last_round[j] = r;
+      if(r > n_round) n_round = r;
+    } // end of i loop
+    // Sort the nodes by rounds, in the order of indices in each round.
+    vector<int> start(n_round+2, 0), order(n);
+    for(int i=0; i<n; i++) start[round[i]+1]++;
+    for(int r=1; r<=n_round+1; r++) start[r] += start[r-1];
+    vector<int> fill(start.begin(), start.end()-1);
+    for(int i=0; i<n; i++) order[fill[round[i]]++] = i;
+    // Run the rounds (round 0 are the idling nodes).
+    for(int r=1; r<=n_round; r++) {
+      int *ops = &order[start[r]];
+      forEachRange(start[r+1]-start[r], [&](int first, int last) {
+	for(int k=first; k<last; k++) {
+	  int i = ops[k];
+	  change[i] = evolveOneLink(i, cand[i], d_rw[i], slot0+i);
+	} // end of k loop
+      });
+    } // end of r loop
+  } // end of if-else (pool == NULL) statement
+
+  // Update the tallies in the order of the node indices.
+  for(int i=0; i<n; i++)
+    if(change[i] != 0) {
+      int ltype = linkType(i, cand[i]);
+      link_count[ltype] += 2*change[i];
+      link_rw[ltype] += d_rw[i];
+      dist_up2date = false;
+    } // end of i loop and if (change[i] not zero) statement
+  compactEdges();
+}
+
+/******************************************************************
+  This function returns the candidate that node $(i) will add 
+    a link to or cut the link with, randomly selected among all 
+    other nodes that are not idling.
+  Input values:
+     $(stream) is the stream of the random numbers (default
+        RNG_EVOLVE).
+     $(draw) points to the index of the next random number of
+        node i, which is advanced past the numbers drawn
+        (default NULL: the numbers are drawn from the index 0).
+  Return value: -1 if node $(i) is idling.
+ ******************************************************************/
+int nodeList::selectCandidate(int i, int stream, uint32_t *draw) {
+  if(idling[i]) return -1; // skipping the idling nodes
+  int n=opinion.size();
+  uint32_t draw0 = 0; // index of the random numbers drawn for node i
+  if(draw == NULL) draw = &draw0;
+  for(;;) {
+    double tmp = rng.uniform(time_step, i, stream, (*draw)++);
+    int j = static_cast<int>(static_cast<double>(n)*tmp); 
+    if(j<0) j=j+n;
+    else if(j>=n) j=j-n;
+    if(j==i) continue;
+    if(idling[j]) continue; // skipping idling nodes
+    return j;
+  } // end of the loop for searching a candidate to add/break connections
+}
+
+/******************************************************************
+  This function lets node $(i) add a link to its candidate $(j) or
+    cut the link with it if that increases the net utility of i.
+  Only the links of nodes i and j are changed; the tallies are 
+    left to the caller.
+  Input values:
+     $(d_rw) receives the change of the rewards of the link.
+     $(e) is the slot of $(edges) for a new link.
+  Return value: +1 if a link is added, -1 if a link is cut, 0 if 
+    nothing is changed.
+ ******************************************************************/
+int nodeList::evolveOneLink(int i, int j, double &d_rw, int e) {
+  double ut_ij, ut_ji;
+  int decision = decideLink(i, j, ut_ij, ut_ji);
+  if(decision==1) { // add a link
+    insertLink(i, j, ut_ij, ut_ji, e); // also updates num_link
+    d_rw = ut_ij + ut_ji;
+  } else if(decision==-1) { // break a link
+    d_rw = -eraseLink(i, j);
+  }
+  return decision;
+}
+
+/******************************************************************
+  This function decides whether node $(i) adds a link to its
+    candidate $(j) or cuts the link with it, given the current 
+    links of node i. Nothing is changed.
+  Input values:
+     $(ut_ij) and $(ut_ji) receive the utilities of the new link
+        (of node i given by node j and vice versa) if i and j are
+        not linked.
+  Return value: +1 to add a link, -1 to cut the link, 0 to keep
+    the connections as they are.
+ ******************************************************************/
+int nodeList::decideLink(int i, int j, double &ut_ij, double &ut_ji) {
+  /* ===== 
+     Here a node is either adding a connection or deleting one.
+     The probability of adding a link is reduced 
+         by the number of links the node already has.
+     ===== */
+  int nlinki = num_link.at(i);
+  double ut_opt; // change of the utility of node i
+  int ij = findLink(i, j);  // offset of j in adjList[i], or -1
+  int check_connection = (ij == -1) ? 0 : 1;
+  if(nlinki==0) check_connection=0;
+  if(check_connection==0) { // candidate for making a connection
+    utilityPair(i, j, ut_ij, ut_ji);
+    ut_opt = ut_ij;
+  } else                    // candidate for disconnecting
+    ut_opt = -linkUtility(i, ij);
+
+  // Check whether add or break a link gets more utility
+  /* =====
+     Here we check if it increases the net utility by changing 
+        the current connection status.
+     If j is connected with i, cutting the connection loses the
+        rewards from the connection but saves the costs of keeping 
+        the connection.
+     If j is not connected with i, adding the new connection gets
+        additional rewards from the connection but also incurs the
+        costs of keeping one additional connection.
+     ===== */
+  double cost_ori = linkCost(nlinki);
+  double cost_opt;
+  if(check_connection==0)
+    cost_opt = linkCost(nlinki+1); // new cost of adding a link
+  else
+    cost_opt = linkCost(nlinki-1); // new cost of cutting a link
+  double diff_ori = - cost_ori;
+  double diff_opt = ut_opt - cost_opt; 
+  if(diff_opt < diff_ori) return 0; // no gain from changing connections
+  return (check_connection==0) ? 1 : -1;
+}
+
+/******************************************************************
+  This subroutine evolves the adjacency lists synchronously
+    (the Jacobi-style variant of evolveAdjMatrix, used when the
+    parameter sync_net is set).
+  Every node that is not idling selects its candidate and decides
+    to add or cut a link in the same way as in evolveAdjMatrix,
+    but all decisions are made with the links of time t, so they
+    are independent of each other and run in parallel.
+  The decisions are then applied in the order of the node indices.
+    If both ends of a pair decide on the same pair, they see the
+    same link and make the same kind of decision; the link is then
+    added (or cut) only once. A node may thus gain or lose more
+    than one link in a step.
+ ******************************************************************/
+void nodeList::evolveAdjMatrixSync(void) {
+  int n=opinion.size();
+  // If something has a wrong size, recreate the utility lists,
+  //   which will also correct num_link and adjList
+  if(num_link.size()!=opinion.size() || adjList.size()!=opinion.size()
+     || adjEdge.size()!=opinion.size()) createUtMatrix();
+
+  // Decisions of all nodes against the links of time t
+  vector<int> cand(n), decision(n, 0);
+  vector<double> ut_ij(n), ut_ji(n);
+  forEachNodeRange([&](int first, int last) {
+    for(int i=first; i<last; i++) {
+      cand[i] = selectCandidate(i);
+      if(cand[i] != -1)
+	decision[i] = decideLink(i, cand[i], ut_ij[i], ut_ji[i]);
+    } // end of i loop
+  });
 
+  // Merge the decisions
   for(int i=0; i<n; i++) {
-    /* ===== 
-       Here a node is either adding a connection or deleting one.
-       The probability of adding a link is reduced 
-           by the number of links the node already has.
-	===== */
-    if(memberNodes.at(i).isIdling()) continue; // skipping the idling nodes
-    // Select a candidate to add or break links
-    int nlinki = num_link.at(i);
-    int j_opt;
-    vector<double> ut_opt;
-    int check_connection;
-    for(bool opt_found=false; opt_found==false;) {
-      double tmp = static_cast<double>(rand())
-	/static_cast<double>(RAND_MAX);
-      int j = static_cast<int>(static_cast<double>(n)*tmp); 
-      if(j<0) j=j+n;
-      else if(j>=n) j=j-n;
-      if(j==i) continue;
-      if(memberNodes.at(j).isIdling()) continue; // skipping idling nodes
-      int ij=i*n+j, ji=j*n+i;
-      check_connection = adjMatrix.at(ij);
-      if(nlinki==0) check_connection=0;
-      if(check_connection==0) {
-	ut_opt = utilityFunction( memberNodes[i].getNodeType(),
-				  memberNodes[i].getOpinion(),
-				  memberNodes[j].getNodeType(),
-				  memberNodes[j].getOpinion() );
-	j_opt = j;         // candidate for making a connection
-	opt_found = true;
-      } else if(check_connection==1) {
-	ut_opt.push_back(-utMatrix.at(ij));
-	j_opt = j;          // candidate for disconnecting
-	opt_found = true;
-      }
-    } // end of the loop for searching a candidate to add/break connections
-
-    // Check whether add or break a link gets more utility
-    /* =====
-       Here we check if it increases the net utility by changing 
-          the current connection status.
-       If j_opt is connected with i, cutting the connection loses the
-          rewards from the connection but saves the costs of keeping 
-          the connection.
-       If j_opt is not connected with i, adding the new connection gets
-          additional rewards from the connection but also incurs the
-          costs of keeping one additional connection.
-       ===== */
-    double cost_ori = exp(nlinki/par.alpha);
-    double cost_opt;
-    if(check_connection==0)
-      cost_opt = exp((nlinki+1)/par.alpha); // new cost of adding a link
-    else if(check_connection==1)
-      cost_opt = exp((nlinki-1)/par.alpha); // new cost of cutting a link
-    double diff_ori = - cost_ori;
-    double diff_opt = ut_opt.at(0) - cost_opt; 
-    if(diff_opt >= diff_ori) { // if changing connections gets more utility
-      if(check_connection==0) { // add a link
-	int ij=i*n+j_opt, ji=j_opt*n+i;
-	adjMatrix.at(ij) = 1;            // update adjacency matrix
-	adjMatrix.at(ji) = 1;
-	utMatrix.at(ij) = ut_opt.at(0);  // update utility matrix
-	utMatrix.at(ji) = ut_opt.at(1);
-	num_link.at(i)++;                // num_link increases by 1
-	num_link.at(j_opt)++;
-      } else if (check_connection==1) { // break a link
-	int ij=i*n+j_opt, ji=j_opt*n+i;
-	adjMatrix.at(ij) = 0;           // update adjacency matrix
-	adjMatrix.at(ji) = 0;
-	utMatrix.at(ij) = 0.0;          // update utility matrix
-	utMatrix.at(ji) = 0.0;
-	num_link.at(i)--;               // num_link decreases by 1
-	num_link.at(j_opt)--;
-      } // end of adding/breaking a link
-    } // end of if statement diff_opt >= diff_ori
-  } // end of i loop  
+    if(decision[i]==1 && findLink(i, cand[i])==-1)
+      addLink(i, cand[i], ut_ij[i], ut_ji[i]);
+    else if(decision[i]==-1 && findLink(i, cand[i])!=-1)
+      cutLink(i, cand[i]);
+  } // end of i loop
+  compactEdges();
 }
 
 /******************************************************************
-  This subroutines updates the list of connections (i.e., edges) 
-    of each node based on the adjacency matrix. 
+  This subroutines refreshes the total utility and the cost of
+    every node from the current utility lists, and updates the
+    statistics of links and rewards.
   -----
-  Note: This subroutine first erases the list of connections of a
-        node and then recreate the list from the adjacency matrix.
-        The vector $(con_time) is also reset here as a result, 
-        rendering it useless in the current version. 
-        In order for $(con_time) to properly count the duration of
-        connection, the list of connections should be updated in
-        the evolveAdjMatrix subroutine, which should leave
-        $(con_time) intact. 
+  Note: Links are no longer added or erased here; this is done in
+        place by addLink and cutLink (see evolveAdjMatrix), and the
+        duration of each connection is counted from the time step
+        when its link was made (see EdgeListC.hpp). The statistics
+        are computed from the tallies $(link_count) and $(link_rw)
+        kept up to date by those events.
  ******************************************************************/
 void nodeList::updateConnection(void) {
-  int n=memberNodes.size();
-  int m=n*n;
-  if(adjMatrix.size() != m || utMatrix.size()!=m) {
-    cout << "Error in updateconnection: wrong dimension of adjMatrix or utMatrix" << endl;
+  int n=opinion.size();
+  if(adjList.size()!=opinion.size() || adjEdge.size()!=opinion.size()) {
+    cout << "Error in updateconnection: wrong dimension of adjList or adjEdge" << endl;
     exit(1);
   }
 
+  forEachNodeRange([&](int first, int last) {
+    for(int i=first; i<last; i++) {
+      // Compute the cost of maintaining the links and
+      //   the rewards provided by those links.
+      int nlinki = num_link[i];
+      double tut = 0.0;
+      for(int k=0; k<nlinki; k++)
+	tut += linkUtility(i, k);
+      total_utility[i] = tut;
+      cost[i] = linkCost(nlinki);
+    } // end of i loop
+  }); // end of forEachNodeRange
   int tot_link = 0;
-  int hh_link=0, gg_link=0, hg_link=0;
-  double tot_rw = 0.;
-  double hh_rw=0., gg_rw=0., hg_rw=0.;
-  for(int i=0; i<n; i++) {
-    memberNodes[i].deleteAllConnections();  // erasing all connections
-    vector<long unsigned int> tmp_connect;
-    vector<double> tmp_ut, tmp_op;
-    for(int j=0; j<n; j++) {  // recreating all connections from adjMatrix
-      int ij = i*n+j;
-      int inode = memberNodes[i].getNodeType();
-      if(adjMatrix[ij]==1) {
-	memberNodes[i].addAConnection( memberNodes[j].getId(), 
-				       memberNodes[j].getOpinion(),
-				       utMatrix[ij]);  
-	int jnode = memberNodes[j].getNodeType();
-
-	// Count the number of host-host, guest-guest, host-guest links,
-        //    as well as the rewards they provide
-	if(inode == 1) {
-	  if(jnode == 1) {
-	    hh_link++;
-	    hh_rw += utMatrix[ij]; // rewards from host-host links
-	  } else {
-	    hg_link++;
-	    hg_rw += utMatrix[ij]; // rewards from host-guest links
-	  } 
-	} else {
-	  if(jnode == 1) {
-	    hg_link++;
-	    hg_rw += utMatrix[ij]; // rewards from host-guest links
-	  } else {
-	    gg_link++;
-	    gg_rw += utMatrix[ij]; // rewards from guest-guest links
-	  } 
-	} 
-      } // end of if (adjMatrix[ij]==1) statement.
-    } // end of j loop
-
-    // Compute the cost of maintaining the links and 
-    //   the rewards provided by those links.
-    int nlinki = num_link.at(i);
-    memberNodes[i].setCost(exp(static_cast<double>(nlinki)/par.alpha));
-    memberNodes[i].computeTotalUtility(); 
-    
-    tot_link += nlinki;
-    tot_rw += memberNodes[i].getTotalUtility(); // total reward node i gets
-  } // end of i loop
+  for(int i=0; i<n; i++)
+    tot_link += num_link[i];
 
   // Update the statistics of the average number of links per node.
   //   (total per node, host-host per host, host-guest per host,
   //    host-guest per guest, guest-guest per guest)
+  int hh_link=link_count[0], hg_link=link_count[1], gg_link=link_count[2];
   double tmp_link[] = {static_cast<double>(tot_link)/static_cast<double>(n),
 		       static_cast<double>(hh_link)/static_cast<double>(num_host),
 		       static_cast<double>(hg_link)/static_cast<double>(num_host)/2,
@@ -697,9 +1275,8 @@ void nodeList::updateConnection(void) {
 		       static_cast<double>(gg_link)/static_cast<double>(num_guest) };
   stats.avg_link.clear(); stats.avg_link.assign(tmp_link, tmp_link+5);
   // Update the statistics of the reward from each type of links.
+  double hh_rw=link_rw[0], hg_rw=link_rw[1], gg_rw=link_rw[2];
+  double tot_rw = hh_rw + hg_rw + gg_rw;
   double tmp_rw[] = {tot_rw, hh_rw, gg_rw, hg_rw };
   stats.avg_rw.clear(); stats.avg_rw.assign(tmp_rw, tmp_rw+4);
-
-  dist_up2date = false; // Since connections are changed, set the flag of the distance matrix to false so that it will be recaluclated.
 }
-
@@ -0,0 +1,389 @@
+/* ============================================================
+   Source codes for the nodeList data class (part VI)
+   This file contains the subroutines that write the complete
+     state of a simulation to a checkpoint file and restore it.
+	    the constructor from a checkpoint
+	    bool writeCheckpoint
+   -----
+    Note:
+       A restored list continues the run bit-identically: the random
+          numbers are keyed by the seed and the time step (see
+          RandomC.hpp), so the state of the generator is the seed,
+          and everything else that the next time steps read is saved
+          as it is, including the order of the adjacency lists, the
+          slots of the links, and the schedule of the events.
+       Format of the file (version 1, all numbers little-endian):
+          checkpointHeader (see below)
+          n_param entries of checkpointParameter
+          the arrays of the nodes: opinion, cost, total_utility
+             (n doubles each), node_type, num_link (n int32 each),
+             idling (n bytes), agents (pos, vel, force: 6n doubles)
+          the adjacency lists as offsets (n+1 int64) and the partners
+             (int32), and the slots of adjEdge (int32) if saved
+          the arrays of the links: lo, hi, tag (n_slot int32 each),
+             ut_lo, ut_hi (n_slot doubles each), since (n_slot int64)
+          op_ut (n doubles) if saved
+          the times and the rates of the events (2n doubles each)
+             if saved
+       Every block starts at a multiple of 8 bytes (padded with 0),
+          so the file can be mapped into memory and the arrays read
+          in place.
+       The file is written to $(file_name).tmp, flushed to the disk,
+          and then renamed, so a checkpoint is either complete or
+          not there at all, even if the run is killed while writing;
+          the directory is flushed after the rename, so the new name
+          survives a crash of the machine too.
+
+   Author: Yao-li Chuang
+   ============================================================ */
+#include"NodeListC.hpp"
+#include<cstdio>
+#include<unistd.h>
+#include<fcntl.h>
+
+#define CHECKPOINT_VERSION 1
+
+// Flags of what a checkpoint contains
+#define CK_UT_UP2DATE     1  // ut_up2date
+#define CK_OP_UT          2  // op_ut is saved
+#define CK_EVENTS         4  // the events are saved
+#define CK_EVENTS_UP2DATE 8  // events_up2date
+#define CK_ADJEDGE       16  // adjEdge is saved (the links are listed)
+
+/**************************************************************
+  The header of a checkpoint file (64-bit fields, 8-byte aligned)
+ **************************************************************/
+struct checkpointHeader {
+  char magic[8];          // "ADCHKPT1"
+  uint32_t version;       // CHECKPOINT_VERSION
+  uint32_t n_param;       // number of checkpointParameter entries
+  int64_t n_node, num_host, num_guest;
+  int64_t time_step;
+  uint64_t seed;
+  int64_t n_slot;         // slots of the links
+  int64_t n_adj;          // entries of the adjacency lists
+  int64_t flags;          // CK_* above
+  int64_t link_count[3];
+  double link_rw[3];
+  double event_time;
+  double avg_link[5];     // statistics kept between time steps
+  double avg_rw[4];
+};
+
+/**************************************************************
+  A model parameter by its name, restored by changeParameter
+ **************************************************************/
+struct checkpointParameter {
+  char name[23];
+  char is_bool;
+  double value;
+};
+
+/************************************************************************
+  These subroutines write and read $(bytes) bytes at the position of
+    the file, padded to a multiple of 8. writeBlock returns false if
+    the bytes could not be written.
+*************************************************************************/
+static bool writeBlock(FILE *file, const void *data, size_t bytes) {
+  static const char zeros[8] = {0};
+  if(bytes > 0 && fwrite(data, 1, bytes, file) != bytes) return false;
+  size_t pad = (8 - bytes%8)%8;
+  return pad == 0 || fwrite(zeros, 1, pad, file) == pad;
+}
+
+static void readBlock(FILE *file, void *data, size_t bytes) {
+  char pad[8];
+  size_t n_pad = (8 - bytes%8)%8;
+  if((bytes > 0 && fread(data, 1, bytes, file) != bytes)
+     || (n_pad > 0 && fread(pad, 1, n_pad, file) != n_pad)) {
+    cout << "Error in nodeList: the checkpoint file is truncated" << endl;
+    exit(1);
+  }
+}
+
+/************************************************************************
+  Constructor of a node list from a checkpoint file written by
+    writeCheckpoint; the list continues the run from the time step
+    of the checkpoint.
+  Inputs:
+     file_name - name of the checkpoint file
+*************************************************************************/
+nodeList::nodeList(string file_name) {
+  FILE *file = fopen(file_name.data(), "rb");
+  if(file == NULL) {
+    cout << "Error in nodeList: unable to open " << file_name << endl;
+    exit(1);
+  }
+  struct checkpointHeader head;
+  readBlock(file, &head, sizeof(head));
+  if(memcmp(head.magic, "ADCHKPT1", 8) != 0
+     || head.version != CHECKPOINT_VERSION) {
+    cout << "Error in nodeList: " << file_name
+	 << " is not a checkpoint of version " << CHECKPOINT_VERSION << endl;
+    exit(1);
+  }
+  int n = head.n_node;
+  pool = NULL;
+  opinion.resize(n); // for setDefaultParameters
+  setDefaultParameters();
+
+  // Parameters, by their names
+  vector<struct checkpointParameter> param(head.n_param);
+  readBlock(file, param.data(), param.size()*sizeof(checkpointParameter));
+  for(size_t p=0; p<param.size(); p++) {
+    string pname(param[p].name, strnlen(param[p].name, sizeof(param[p].name)));
+    if(param[p].is_bool)
+      changeParameter(pname, param[p].value != 0.0);
+    else
+      changeParameter(pname, param[p].value);
+  } // end of p loop
+  rng.setSeed(head.seed);
+  time_step = head.time_step;
+  num_host = head.num_host;
+  num_guest = head.num_guest;
+
+  // Nodes
+  cost.resize(n); total_utility.resize(n);
+  node_type.resize(n); num_link.resize(n); idling.resize(n);
+  readBlock(file, opinion.data(), n*sizeof(double));
+  readBlock(file, cost.data(), n*sizeof(double));
+  readBlock(file, total_utility.data(), n*sizeof(double));
+  readBlock(file, node_type.data(), n*sizeof(int));
+  readBlock(file, num_link.data(), n*sizeof(int));
+  readBlock(file, idling.data(), n*sizeof(char));
+  vector<double> xy(6*n);
+  readBlock(file, xy.data(), xy.size()*sizeof(double));
+  agents.resize(n);
+  for(int i=0; i<n; i++) {
+    const double *a = &xy[6*i];
+    agents[i].setPos(vector<double>(a, a+2));
+    agents[i].setVel(vector<double>(a+2, a+4));
+    agents[i].setForce(vector<double>(a+4, a+6));
+  } // end of i loop
+
+  // Adjacency lists
+  vector<int64_t> offset(n+1);
+  vector<int> flat(head.n_adj);
+  readBlock(file, offset.data(), offset.size()*sizeof(int64_t));
+  readBlock(file, flat.data(), flat.size()*sizeof(int));
+  adjList.resize(n);
+  for(int i=0; i<n; i++)
+    adjList[i].assign(flat.begin()+offset[i], flat.begin()+offset[i+1]);
+  adjEdge.clear();
+  if(head.flags & CK_ADJEDGE) {
+    readBlock(file, flat.data(), flat.size()*sizeof(int));
+    adjEdge.resize(n);
+    for(int i=0; i<n; i++)
+      adjEdge[i].assign(flat.begin()+offset[i], flat.begin()+offset[i+1]);
+  } // end of if (adjEdge saved) statement
+
+  // Links
+  int m = head.n_slot;
+  vector<int> lo(m), hi(m), tag(m);
+  vector<double> ut_lo(m), ut_hi(m);
+  vector<int64_t> since(m);
+  readBlock(file, lo.data(), m*sizeof(int));
+  readBlock(file, hi.data(), m*sizeof(int));
+  readBlock(file, tag.data(), m*sizeof(int));
+  readBlock(file, ut_lo.data(), m*sizeof(double));
+  readBlock(file, ut_hi.data(), m*sizeof(double));
+  readBlock(file, since.data(), m*sizeof(int64_t));
+  edges.clear();
+  edges.reserve(m);
+  for(int e=0; e<m; e++)
+    if(tag[e] != EDGE_FREE)
+      edges.set(e, lo[e], hi[e], tag[e], ut_lo[e], ut_hi[e], since[e]);
+  for(int k=0; k<3; k++) {
+    link_count[k] = head.link_count[k];
+    link_rw[k] = head.link_rw[k];
+  } // end of k loop
+
+  // State of the lazy utilities and of the events
+  setCostTable(n);
+  ut_up2date = (head.flags & CK_UT_UP2DATE) != 0;
+  op_ut.clear();
+  if(head.flags & CK_OP_UT) {
+    op_ut.resize(n);
+    readBlock(file, op_ut.data(), n*sizeof(double));
+  }
+  events_up2date = false;
+  event_time = head.event_time;
+  if(head.flags & CK_EVENTS) {
+    vector<double> t(2*n);
+    event_rate.resize(2*n);
+    readBlock(file, t.data(), t.size()*sizeof(double));
+    readBlock(file, event_rate.data(), event_rate.size()*sizeof(double));
+    events.assign(t);
+    // The counts of the saturated nodes are exact, so counting them
+    //   again gives the values kept by the events.
+    n_active = 0;
+    for(int i=0; i<n; i++)
+      if(!idling[i]) n_active++;
+    n_cuttable.resize(n);
+    saturated.resize(n);
+    for(int i=0; i<n; i++)
+      countCuttable(i);
+    events_up2date = (head.flags & CK_EVENTS_UP2DATE) != 0;
+  } // end of if (events saved) statement
+  fclose(file);
+
+  prefix_up2date = false;
+  stats.avg_link.assign(head.avg_link, head.avg_link+5);
+  stats.avg_rw.assign(head.avg_rw, head.avg_rw+4);
+  distMatrix.clear();
+  dist_up2date = false;
+}
+
+/************************************************************************
+  This function writes the complete state of the list to a checkpoint
+    file, from which the constructor above continues the run.
+  Inputs:
+     file_name - name of the checkpoint file (replaced atomically)
+  Return value: whether the checkpoint was written; a failure (e.g., a
+     full disk) is reported and leaves the previous checkpoint intact.
+*************************************************************************/
+bool nodeList::writeCheckpoint(string file_name) {
+  int n = opinion.size(), m = edges.getNumSlots();
+  bool has_edge = (adjEdge.size() == opinion.size());
+  bool has_events = (events.size() == 2*n && event_rate.size() == 2*opinion.size());
+
+  struct checkpointHeader head;
+  memset(&head, 0, sizeof(head));
+  memcpy(head.magic, "ADCHKPT1", 8);
+  head.version = CHECKPOINT_VERSION;
+  head.n_node = n;
+  head.num_host = num_host;
+  head.num_guest = num_guest;
+  head.time_step = time_step;
+  head.seed = rng.getSeed();
+  head.n_slot = m;
+  head.flags = (ut_up2date ? CK_UT_UP2DATE : 0)
+    | (op_ut.size() == opinion.size() ? CK_OP_UT : 0)
+    | (has_events ? CK_EVENTS : 0)
+    | (has_events && events_up2date ? CK_EVENTS_UP2DATE : 0)
+    | (has_edge ? CK_ADJEDGE : 0);
+  for(int k=0; k<3; k++) {
+    head.link_count[k] = link_count[k];
+    head.link_rw[k] = link_rw[k];
+  } // end of k loop
+  head.event_time = event_time;
+  for(size_t k=0; k<5 && k<stats.avg_link.size(); k++)
+    head.avg_link[k] = stats.avg_link[k];
+  for(size_t k=0; k<4 && k<stats.avg_rw.size(); k++)
+    head.avg_rw[k] = stats.avg_rw[k];
+
+  // Parameters, by their names
+  const char *real_name[] = {"AH", "AG", "sigmaH", "sigmaG", "kappa",
+			     "alpha", "gamma", "welfare", "ini_hlink_frac",
+			     "dense_mb", "ut_epsilon"};
+  double real_value[] = {par.AH, par.AG, par.sigmaH, par.sigmaG, par.kappa,
+			 par.alpha, par.gamma, par.welfare, par.ini_hlink_frac,
+			 par.dense_mb, par.ut_epsilon};
+  const char *bool_name[] = {"enable_op", "enable_net", "sync_net",
+			     "fast_exp", "event_driven", "ut_verify"};
+  bool bool_value[] = {par.enable_op, par.enable_net, par.sync_net,
+		       par.fast_exp, par.event_driven, par.ut_verify};
+  int n_real = sizeof(real_value)/sizeof(double);
+  int n_bool = sizeof(bool_value)/sizeof(bool);
+  vector<struct checkpointParameter> param(n_real+n_bool);
+  memset(param.data(), 0, param.size()*sizeof(checkpointParameter));
+  for(int p=0; p<n_real+n_bool; p++) {
+    bool is_bool = (p >= n_real);
+    strncpy(param[p].name, is_bool ? bool_name[p-n_real] : real_name[p],
+	    sizeof(param[p].name)-1);
+    param[p].is_bool = is_bool;
+    param[p].value = is_bool ? (bool_value[p-n_real] ? 1.0 : 0.0)
+                             : real_value[p];
+  } // end of p loop
+  head.n_param = param.size();
+
+  // Agents and adjacency lists, flattened
+  vector<double> xy(6*n, 0.0);
+  for(int i=0; i<n; i++) {
+    const vector<double> &pos = agents[i].getPos(), &vel = agents[i].getVel(),
+      &force = agents[i].getForce();
+    for(size_t d=0; d<2; d++) {
+      if(d < pos.size()) xy[6*i+d] = pos[d];
+      if(d < vel.size()) xy[6*i+2+d] = vel[d];
+      if(d < force.size()) xy[6*i+4+d] = force[d];
+    } // end of d loop
+  } // end of i loop
+  vector<int64_t> offset(n+1, 0);
+  for(int i=0; i<n; i++)
+    offset[i+1] = offset[i] + adjList[i].size();
+  head.n_adj = offset[n];
+  vector<int> flat_list(offset[n]), flat_edge;
+  for(int i=0; i<n; i++)
+    copy(adjList[i].begin(), adjList[i].end(), flat_list.begin()+offset[i]);
+  if(has_edge) {
+    flat_edge.resize(offset[n]);
+    for(int i=0; i<n; i++)
+      copy(adjEdge[i].begin(), adjEdge[i].end(), flat_edge.begin()+offset[i]);
+  }
+
+  // Links
+  vector<int> lo(m), hi(m), tag(m);
+  vector<double> ut_lo(m), ut_hi(m);
+  vector<int64_t> since(m);
+  for(int e=0; e<m; e++) {
+    lo[e] = edges.getLo(e);
+    hi[e] = edges.getHi(e);
+    tag[e] = edges.getTag(e);
+    ut_lo[e] = (tag[e] == EDGE_FREE) ? 0.0 : edges.getUtility(e, lo[e]);
+    ut_hi[e] = (tag[e] == EDGE_FREE) ? 0.0 : edges.getUtility(e, hi[e]);
+    since[e] = edges.getSince(e);
+  } // end of e loop
+
+  // Write everything to a temporary file and rename it
+  string tmp_name = file_name + ".tmp";
+  FILE *file = fopen(tmp_name.data(), "wb");
+  if(file == NULL) {
+    cout << "Error in writeCheckpoint: unable to open " << tmp_name << endl;
+    return false;
+  }
+  bool ok = writeBlock(file, &head, sizeof(head))
+    && writeBlock(file, param.data(), param.size()*sizeof(checkpointParameter))
+    && writeBlock(file, opinion.data(), n*sizeof(double))
+    && writeBlock(file, cost.data(), n*sizeof(double))
+    && writeBlock(file, total_utility.data(), n*sizeof(double))
+    && writeBlock(file, node_type.data(), n*sizeof(int))
+    && writeBlock(file, num_link.data(), n*sizeof(int))
+    && writeBlock(file, idling.data(), n*sizeof(char))
+    && writeBlock(file, xy.data(), xy.size()*sizeof(double))
+    && writeBlock(file, offset.data(), offset.size()*sizeof(int64_t))
+    && writeBlock(file, flat_list.data(), flat_list.size()*sizeof(int))
+    && (!has_edge || writeBlock(file, flat_edge.data(), flat_edge.size()*sizeof(int)))
+    && writeBlock(file, lo.data(), m*sizeof(int))
+    && writeBlock(file, hi.data(), m*sizeof(int))
+    && writeBlock(file, tag.data(), m*sizeof(int))
+    && writeBlock(file, ut_lo.data(), m*sizeof(double))
+    && writeBlock(file, ut_hi.data(), m*sizeof(double))
+    && writeBlock(file, since.data(), m*sizeof(int64_t))
+    && (!(head.flags & CK_OP_UT) || writeBlock(file, op_ut.data(), n*sizeof(double)));
+  if(ok && has_events) {
+    vector<double> t(2*n);
+    for(int id=0; id<2*n; id++)
+      t[id] = events.getTime(id);
+    ok = writeBlock(file, t.data(), t.size()*sizeof(double))
+      && writeBlock(file, event_rate.data(), event_rate.size()*sizeof(double));
+  }
+  ok = ok && fflush(file) == 0 && fsync(fileno(file)) == 0;
+  ok = (fclose(file) == 0) && ok;
+  if(!ok || rename(tmp_name.data(), file_name.data()) != 0) {
+    cout << "Error in writeCheckpoint: unable to write " << file_name << endl;
+    remove(tmp_name.data());
+    return false;
+  }
+  // Flush the directory, so the rename itself is on the disk
+  size_t slash = file_name.rfind('/');
+  string dir_name = (slash == string::npos) ? string(".")
+    : (slash == 0) ? string("/") : file_name.substr(0, slash);
+  int dir = open(dir_name.data(), O_RDONLY);
+  if(dir < 0 || fsync(dir) != 0) {
+    cout << "Error in writeCheckpoint: unable to flush " << dir_name << endl;
+    if(dir >= 0) close(dir);
+    return false;
+  }
+  close(dir);
+  return true;
+}
@@ -0,0 +1,297 @@
+/* ============================================================
+   Source codes for the edgeList data class
+   This file contains the following subroutines and functions
+	    void clear
+	    int add
+	    void reserve
+	    void set
+	    int compact
+	    void updateUtilities
+	    void updateSlots
+	    void sumRewards
+	    void updateScalar
+	    void updateAVX2
+	    void updateAVX512
+   -----
+    Note:
+       This file must be compiled with -ffp-contract=off (see
+          GNUmakefile), so that the kernels updateScalar, updateAVX2,
+          and updateAVX512 round in exactly the same way.
+
+   Author: Yao-li Chuang
+   ============================================================ */
+#include"EdgeListC.hpp"
+#include<immintrin.h>
+
+// The coefficients 1/k! of the Taylor polynomial of accurateExp
+const double exp_coef[14] = {
+  1.0, 1.0, 1.0/2.0, 1.0/6.0, 1.0/24.0, 1.0/120.0, 1.0/720.0,
+  1.0/5040.0, 1.0/40320.0, 1.0/362880.0, 1.0/3628800.0,
+  1.0/39916800.0, 1.0/479001600.0, 1.0/6227020800.0
+};
+
+/***********************************************************
+  This subroutine removes all links.
+ ***********************************************************/
+void edgeList::clear(void) {
+  lo.clear(); hi.clear(); tag.clear();
+  ut_lo.clear(); ut_hi.clear(); since.clear();
+}
+
+/***********************************************************
+  This function adds a link between nodes $(i) and $(j) at the
+    end of the arrays.
+  Input values:
+     $(link_tag) is the type of the link.
+     $(ut_i) is the utility of node i given by node j.
+     $(ut_j) is the utility of node j given by node i.
+     $(t) is the time step when the link is made.
+  Return value: the slot of the link
+ ***********************************************************/
+int edgeList::add(int i, int j, int link_tag, double ut_i, double ut_j,
+		  long int t) {
+  int e = lo.size();
+  reserve(1);
+  set(e, i, j, link_tag, ut_i, ut_j, t);
+  return e;
+}
+
+/***********************************************************
+  This subroutine appends $(n_slot) free slots to the arrays,
+    to be filled later by set (e.g., from several threads).
+ ***********************************************************/
+void edgeList::reserve(int n_slot) {
+  int m = lo.size() + n_slot;
+  lo.resize(m, 0); hi.resize(m, 0); tag.resize(m, EDGE_FREE);
+  ut_lo.resize(m, 0.0); ut_hi.resize(m, 0.0); since.resize(m, 0);
+}
+
+/***********************************************************
+  This subroutine puts the link between nodes $(i) and $(j) in
+    slot $(e), with the input values as for add.
+ ***********************************************************/
+void edgeList::set(int e, int i, int j, int link_tag,
+		   double ut_i, double ut_j, long int t) {
+  if(i < j) {
+    lo[e] = i; hi[e] = j; ut_lo[e] = ut_i; ut_hi[e] = ut_j;
+  } else {
+    lo[e] = j; hi[e] = i; ut_lo[e] = ut_j; ut_hi[e] = ut_i;
+  }
+  tag[e] = link_tag;
+  since[e] = t;
+}
+
+/***********************************************************
+  This function moves the links at the end of the arrays into
+    the free slots before them, until the links occupy the slots
+    [0, m) with no free slot in between, and removes the rest.
+  Input values:
+     $(moved) receives the slots that now hold a link moved from
+        another slot (the caller updates its references to them).
+  Return value: the number of links m
+ ***********************************************************/
+int edgeList::compact(vector<int> &moved) {
+  moved.clear();
+  int a = 0, b = lo.size()-1;
+  for(;;) {
+    while(a<=b && tag[a]!=EDGE_FREE) a++; // the first free slot
+    while(b>=a && tag[b]==EDGE_FREE) b--; // the last link
+    if(a >= b) break;
+    lo[a] = lo[b]; hi[a] = hi[b]; tag[a] = tag[b];
+    ut_lo[a] = ut_lo[b]; ut_hi[a] = ut_hi[b]; since[a] = since[b];
+    tag[b] = EDGE_FREE;
+    moved.push_back(a);
+  } // end of the loop moving the links
+  lo.resize(a); hi.resize(a); tag.resize(a);
+  ut_lo.resize(a); ut_hi.resize(a); since.resize(a);
+  return a;
+}
+
+/***********************************************************
+  This subroutine recomputes the utilities of the links in the
+    slots [first, last).
+  Input values:
+     $(op) is the array of the opinions of all nodes.
+     $(c) are the constants of the utility function.
+     $(fast) chooses fastExp instead of accurateExp.
+  The kernel is chosen once by the instruction sets that the
+    processor supports.
+ ***********************************************************/
+void edgeList::updateUtilities(int first, int last, const double *op,
+			       const edgeConstants &c, bool fast) {
+  static const int level = __builtin_cpu_supports("avx512f") ? 2
+                         : (__builtin_cpu_supports("avx2") ? 1 : 0);
+  if(level == 2)
+    updateAVX512(first, last, op, c, fast);
+  else if(level == 1)
+    updateAVX2(first, last, op, c, fast);
+  else
+    updateScalar(first, last, op, c, fast);
+}
+
+/***********************************************************
+  This subroutine recomputes the utilities of the links in the
+    $(n_slot) slots listed in $(slot), e.g., the links of the
+    nodes whose opinions have changed, by the plain C++ kernel.
+  The other input values are the same as in updateUtilities.
+ ***********************************************************/
+void edgeList::updateSlots(const int *slot, int n_slot, const double *op,
+			   const edgeConstants &c, bool fast) {
+  for(int s=0; s<n_slot; s++)
+    updateScalar(slot[s], slot[s]+1, op, c, fast);
+}
+
+/***********************************************************
+  This subroutine adds up the rewards (the utilities of both
+    ends) of the links of each type, in the order of the slots.
+  Input values:
+     $(rw) receives the sums of host-host, host-guest, and
+        guest-guest links.
+ ***********************************************************/
+void edgeList::sumRewards(double rw[3]) {
+  rw[0] = rw[1] = rw[2] = 0.0;
+  int m = lo.size();
+  for(int e=0; e<m; e++)
+    if(tag[e] != EDGE_FREE) rw[tag[e]] += ut_lo[e] + ut_hi[e];
+}
+
+/***********************************************************
+  The kernel in plain C++; it also finishes the slots left
+    over by the vector kernels.
+ ***********************************************************/
+void edgeList::updateScalar(int first, int last, const double *op,
+			    const edgeConstants &c, bool fast) {
+  for(int e=first; e<last; e++) {
+    int t = tag[e];
+    double diff = op[lo[e]] - op[hi[e]];
+    double diff2 = diff*diff;
+    if(fast) {
+      ut_lo[e] = c.A[t] * fastExp(-(diff2*c.inv_lo[t]));
+      ut_hi[e] = c.A[t] * fastExp(-(diff2*c.inv_hi[t]));
+    } else {
+      ut_lo[e] = c.A[t] * accurateExp(-(diff2*c.inv_lo[t]));
+      ut_hi[e] = c.A[t] * accurateExp(-(diff2*c.inv_hi[t]));
+    }
+  } // end of e loop
+}
+
+/***********************************************************
+  fastExp and accurateExp of 4 numbers with AVX2, with the same
+    operations as the scalar versions in EdgeListC.hpp.
+ ***********************************************************/
+__attribute__((target("avx2")))
+static inline __m256d expAVX2(__m256d x, bool fast) {
+  const __m256d lim = _mm256_set1_pd(-708.0);
+  __m256d under = _mm256_cmp_pd(x, lim, _CMP_LT_OQ);
+  x = _mm256_max_pd(x, lim);
+  __m256d k = _mm256_floor_pd(_mm256_add_pd(
+		_mm256_mul_pd(x, _mm256_set1_pd(1.4426950408889634)),
+		_mm256_set1_pd(0.5)));
+  __m256d r, p;
+  if(fast) {
+    r = _mm256_sub_pd(x, _mm256_mul_pd(k, _mm256_set1_pd(0.6931471805599453)));
+    p = _mm256_set1_pd(1.0/720.0);
+    const double coef[6] = {1.0/120.0, 1.0/24.0, 1.0/6.0, 1.0/2.0, 1.0, 1.0};
+    for(int i=0; i<6; i++)
+      p = _mm256_add_pd(_mm256_set1_pd(coef[i]), _mm256_mul_pd(r, p));
+  } else {
+    r = _mm256_sub_pd(_mm256_sub_pd(x, _mm256_mul_pd(k,
+		        _mm256_set1_pd(6.93147180369123816490e-01))),
+		      _mm256_mul_pd(k, _mm256_set1_pd(1.90821492927058770002e-10)));
+    p = _mm256_set1_pd(exp_coef[13]);
+    for(int i=12; i>=0; i--)
+      p = _mm256_add_pd(_mm256_set1_pd(exp_coef[i]), _mm256_mul_pd(r, p));
+  }
+  // 2^k from the low bits of k+1023+2^52 (see expScale)
+  __m256i bits = _mm256_castpd_si256(_mm256_add_pd(k,
+		   _mm256_set1_pd(1023.0 + 4503599627370496.0)));
+  __m256d scale = _mm256_castsi256_pd(_mm256_slli_epi64(bits, 52));
+  return _mm256_andnot_pd(under, _mm256_mul_pd(p, scale));
+}
+
+/***********************************************************
+  The kernel with AVX2, 4 links at a time.
+ ***********************************************************/
+__attribute__((target("avx2")))
+void edgeList::updateAVX2(int first, int last, const double *op,
+			  const edgeConstants &c, bool fast) {
+  const __m256d sign = _mm256_set1_pd(-0.0);
+  int e = first;
+  for(; e+4<=last; e+=4) {
+    __m128i vlo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&lo[e]));
+    __m128i vhi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&hi[e]));
+    __m128i vtag = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&tag[e]));
+    __m256d diff = _mm256_sub_pd(_mm256_i32gather_pd(op, vlo, 8),
+				 _mm256_i32gather_pd(op, vhi, 8));
+    __m256d diff2 = _mm256_mul_pd(diff, diff);
+    __m256d A = _mm256_i32gather_pd(c.A, vtag, 8);
+    __m256d x_lo = _mm256_xor_pd(sign, _mm256_mul_pd(diff2,
+				   _mm256_i32gather_pd(c.inv_lo, vtag, 8)));
+    __m256d x_hi = _mm256_xor_pd(sign, _mm256_mul_pd(diff2,
+				   _mm256_i32gather_pd(c.inv_hi, vtag, 8)));
+    _mm256_storeu_pd(&ut_lo[e], _mm256_mul_pd(A, expAVX2(x_lo, fast)));
+    _mm256_storeu_pd(&ut_hi[e], _mm256_mul_pd(A, expAVX2(x_hi, fast)));
+  } // end of e loop
+  updateScalar(e, last, op, c, fast);
+}
+
+/***********************************************************
+  fastExp and accurateExp of 8 numbers with AVX-512.
+ ***********************************************************/
+__attribute__((target("avx512f")))
+static inline __m512d expAVX512(__m512d x, bool fast) {
+  const __m512d lim = _mm512_set1_pd(-708.0);
+  __mmask8 under = _mm512_cmp_pd_mask(x, lim, _CMP_LT_OQ);
+  x = _mm512_max_pd(x, lim);
+  __m512d k = _mm512_roundscale_pd(_mm512_add_pd(
+		_mm512_mul_pd(x, _mm512_set1_pd(1.4426950408889634)),
+		_mm512_set1_pd(0.5)), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+  __m512d r, p;
+  if(fast) {
+    r = _mm512_sub_pd(x, _mm512_mul_pd(k, _mm512_set1_pd(0.6931471805599453)));
+    p = _mm512_set1_pd(1.0/720.0);
+    const double coef[6] = {1.0/120.0, 1.0/24.0, 1.0/6.0, 1.0/2.0, 1.0, 1.0};
+    for(int i=0; i<6; i++)
+      p = _mm512_add_pd(_mm512_set1_pd(coef[i]), _mm512_mul_pd(r, p));
+  } else {
+    r = _mm512_sub_pd(_mm512_sub_pd(x, _mm512_mul_pd(k,
+		        _mm512_set1_pd(6.93147180369123816490e-01))),
+		      _mm512_mul_pd(k, _mm512_set1_pd(1.90821492927058770002e-10)));
+    p = _mm512_set1_pd(exp_coef[13]);
+    for(int i=12; i>=0; i--)
+      p = _mm512_add_pd(_mm512_set1_pd(exp_coef[i]), _mm512_mul_pd(r, p));
+  }
+  __m512i bits = _mm512_castpd_si512(_mm512_add_pd(k,
+		   _mm512_set1_pd(1023.0 + 4503599627370496.0)));
+  __m512d scale = _mm512_castsi512_pd(_mm512_slli_epi64(bits, 52));
+  return _mm512_maskz_mov_pd(static_cast<__mmask8>(~under),
+			     _mm512_mul_pd(p, scale));
+}
+
+/***********************************************************
+  The kernel with AVX-512, 8 links at a time.
+ ***********************************************************/
+__attribute__((target("avx512f")))
+void edgeList::updateAVX512(int first, int last, const double *op,
+			    const edgeConstants &c, bool fast) {
+  const __m512i sign = _mm512_set1_epi64(static_cast<long long>(0x8000000000000000ULL));
+  int e = first;
+  for(; e+8<=last; e+=8) {
+    __m256i vlo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&lo[e]));
+    __m256i vhi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&hi[e]));
+    __m256i vtag = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&tag[e]));
+    __m512d diff = _mm512_sub_pd(_mm512_i32gather_pd(vlo, op, 8),
+				 _mm512_i32gather_pd(vhi, op, 8));
+    __m512d diff2 = _mm512_mul_pd(diff, diff);
+    __m512d A = _mm512_i32gather_pd(vtag, c.A, 8);
+    __m512d x_lo = _mm512_castsi512_pd(_mm512_xor_si512(sign,
+		     _mm512_castpd_si512(_mm512_mul_pd(diff2,
+		       _mm512_i32gather_pd(vtag, c.inv_lo, 8)))));
+    __m512d x_hi = _mm512_castsi512_pd(_mm512_xor_si512(sign,
+		     _mm512_castpd_si512(_mm512_mul_pd(diff2,
+		       _mm512_i32gather_pd(vtag, c.inv_hi, 8)))));
+    _mm512_storeu_pd(&ut_lo[e], _mm512_mul_pd(A, expAVX512(x_lo, fast)));
+    _mm512_storeu_pd(&ut_hi[e], _mm512_mul_pd(A, expAVX512(x_hi, fast)));
+  } // end of e loop
+  updateScalar(e, last, op, c, fast);
+}
@@ -0,0 +1,163 @@
+/* ============================================================
+   Header file for the edgeList data class
+   -----
+   Brief Summary: The edgeList class stores the links of the
+                  network as a structure of arrays, one entry
+                  (slot) per link, so that the utilities of all
+                  links can be recomputed in one streaming pass.
+   -----
+      variables --
+          lo, hi : indices of the two nodes of each link (lo < hi)
+          tag : type of each link (0: host-host, 1: host-guest,
+                2: guest-guest, EDGE_FREE: an unused slot)
+          ut_lo : utility of node lo given by node hi
+          ut_hi : utility of node hi given by node lo
+          since : time step when each link was made
+   -----
+      Since the hosts occupy the node indices before the guests,
+        node lo of a host-guest link is always the host.
+      Slots of removed links are only marked EDGE_FREE, so that
+        links of different pairs of nodes can be removed at the
+        same time from different threads; compact moves the links
+        at the end of the arrays into the free slots later.
+   -----
+      The utilities are computed by updateUtilities with one of 3
+        kernels chosen at run time: AVX-512, AVX2, or plain C++.
+        The 3 kernels do the same operations in the same order
+        (the codes are compiled without contracting a*b+c into
+        fused multiply-adds, see GNUmakefile), so the results do not
+        depend on the processor, and agree with the utilities of
+        new links computed by the inline functions of NodeListC.hpp.
+   -----
+       Functions and subroutines not defined explicitly here are
+          defined in EdgeListC.cxx.
+
+   Author: Yao-li Chuang
+   ============================================================ */
+#ifndef __EdgeListC_hpp_INCLUDED__
+#define __EdgeListC_hpp_INCLUDED__
+
+#include"../CCommon.h"
+#include<cstring>
+#include<stdint.h>
+
+#define EDGE_FREE 3 // tag of an unused slot
+
+/**************************************************************
+  The constants of the utility function for each tag of links:
+    the utilities of a link are
+       ut_lo = A[tag] * exp(-d^2 * inv_lo[tag])
+       ut_hi = A[tag] * exp(-d^2 * inv_hi[tag])
+    with d the difference of the opinions of nodes lo and hi.
+  The entries of EDGE_FREE are 0, which gives free slots the
+    utility 0.
+ **************************************************************/
+struct edgeConstants {
+  double A[4];
+  double inv_lo[4];
+  double inv_hi[4];
+};
+
+/**************************************************************
+  Approximations of exp(x) shared by all kernels.
+  x is split as k*ln2 + r with an integer k and |r| <= ln2/2;
+    exp(r) is computed by its Taylor polynomial, and 2^k is set
+    directly in the exponent bits of the result.
+  --- fastExp: polynomial of degree 6. The relative error is
+        below 2e-7 (the Taylor remainder is at most
+        exp(r) r^7/7! < 1.7e-7).
+  --- accurateExp: polynomial of degree 13 with ln2 split in two
+        parts to reduce x exactly. The relative error is below
+        2e-16, i.e., within 2 units of the last place.
+  Both return 0 for x < -708, where exp would be subnormal.
+    They are meant for the utility function, where x <= 0.
+  accurateExp is used instead of exp of the C library, which the
+    kernels cannot vectorize; the utilities thus differ from those
+    computed with exp in the last bits.
+  The polynomials are written out in the order of evaluation, and
+    every file including this header must be compiled with
+    -ffp-contract=off (see GNUmakefile), or a compiler with FMA
+    enabled may round them differently in different files.
+ **************************************************************/
+inline double expScale(double k) { // 2^k for an integer k in [-1022, 1023]
+  double t = k + (1023.0 + 4503599627370496.0); // k+1023 in the low bits
+  uint64_t bits;
+  memcpy(&bits, &t, sizeof(double));
+  bits <<= 52;
+  memcpy(&t, &bits, sizeof(double));
+  return t;
+}
+
+inline double fastExp(double x) {
+  if(x < -708.0) return 0.0;
+  double k = floor(x*1.4426950408889634 + 0.5); // x/ln2, rounded
+  double r = x - k*0.6931471805599453;
+  double p = 1.0 + r*(1.0 + r*(1.0/2.0 + r*(1.0/6.0 + r*(1.0/24.0
+		 + r*(1.0/120.0 + r*(1.0/720.0))))));
+  return p*expScale(k);
+}
+
+extern const double exp_coef[14]; // 1/k!, in EdgeListC.cxx
+
+inline double accurateExp(double x) {
+  if(x < -708.0) return 0.0;
+  double k = floor(x*1.4426950408889634 + 0.5); // x/ln2, rounded
+  double r = (x - k*6.93147180369123816490e-01) - k*1.90821492927058770002e-10;
+  double p = exp_coef[13];
+  for(int i=12; i>=0; i--)
+    p = exp_coef[i] + r*p;
+  return p*expScale(k);
+}
+
+/**************************************************************
+   edgeList data class
+ **************************************************************/
+class edgeList {
+
+public:
+  // Constructor & destructor
+  edgeList(void) {}
+  ~edgeList(void) { clear(); }
+  // Getters
+  int getNumSlots(void) {return lo.size();}
+  int getLo(int e) {return lo[e];}
+  int getHi(int e) {return hi[e];}
+  int getTag(int e) {return tag[e];}
+  // utility of node $(i) (one of the two nodes of link $(e))
+  double getUtility(int e, int i) {return (i == lo[e]) ? ut_lo[e] : ut_hi[e];}
+  long int getSince(int e) {return since[e];}
+  // Adding and removing links ($(t): the time step of the new link)
+  void clear(void);
+  int add(int i, int j, int link_tag, double ut_i, double ut_j,
+	  long int t); // returns the slot
+  void reserve(int n_slot); // append $(n_slot) free slots
+  void set(int e, int i, int j, int link_tag, double ut_i, double ut_j,
+	   long int t);
+  void remove(int e) { tag[e] = EDGE_FREE; ut_lo[e] = ut_hi[e] = 0.0; }
+  // utilities of link $(e) of node $(i) and of the other node
+  void setUtilities(int e, int i, double ut_i, double ut_other) {
+    if(i == lo[e]) { ut_lo[e] = ut_i; ut_hi[e] = ut_other; }
+    else { ut_hi[e] = ut_i; ut_lo[e] = ut_other; }
+  }
+  int compact(vector<int> &moved); // fill the free slots
+  // Computing the utilities
+  void updateUtilities(int first, int last, const double *op,
+		       const edgeConstants &c, bool fast);
+  void updateSlots(const int *slot, int n_slot, const double *op,
+		   const edgeConstants &c, bool fast);
+  void sumRewards(double rw[3]);
+
+private:
+  vector<int> lo, hi, tag;
+  vector<double> ut_lo, ut_hi;
+  vector<long int> since;
+  void updateScalar(int first, int last, const double *op,
+		    const edgeConstants &c, bool fast);
+  void updateAVX2(int first, int last, const double *op,
+		  const edgeConstants &c, bool fast);
+  void updateAVX512(int first, int last, const double *op,
+		    const edgeConstants &c, bool fast);
+};
+
+
+#endif
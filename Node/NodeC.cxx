@@ -1,198 +1,131 @@
 /* ============================================================
    Source codes for the node data class
 
+   The properties of the node are read from (and written to) the
+     arrays of its nodeList. The connections are listed in the
+     order of adjList, i.e., by ascending index of the partner.
+
    Author: Yao-li Chuang
    ============================================================ */
 #include"NodeC.hpp"
+#include"NodeListC.hpp"
 
 /*********************************************************************
- Constructor of the node data class.
- Input --
-     ntype : type of node (+1: host, -1: guest)
-     ini_op : initial opinion
-              host node: 0 < ini_op <= 1
-              guest node: -1 <= ini_op < 0
+ Getters and setters of the properties of the node.
+ Setting the opinion makes the utilities of the list out-of-date,
+   so that they are recomputed at the next time step, and so does
+   setting the idling mode with the events of the list.
 **********************************************************************/
-node::node(int ntype, double ini_op): idling(false), node_type(ntype),
-				      opinion(ini_op),
-				      total_utility(0.0), cost(0.0),
-				      ut_cost(0.0) {
-  static long unsigned int totalId = 0;
-  id = totalId++;               // give the agent an id.
+bool node::isIdling(void) {return list->idling[id];}
+void node::setIdling(bool value) {
+  list->idling[id] = value;
+  list->events_up2date = false;
+}
+double node::getOpinion(void) {return list->opinion[id];}
+void node::setOpinion(double value) {
+  list->opinion[id] = value;
+  list->ut_up2date = false;
+}
+double node::getTotalUtility(void) {return list->total_utility[id];}
+double node::getUtCost(void) {
+  return list->total_utility[id] - list->cost[id];
+}
+double node::getCost(void) {return list->cost[id];}
+int node::getNodeType(void) {return list->node_type[id];}
+const agent &node::getGraphAgent(void) {return list->agents[id];}
+void node::setGraphAgent(agent value) {list->agents[id] = value;}
 
-  if(!connections.empty()) connections.clear();
-  if(!utility.empty()) utility.clear();
-  if(!con_op.empty()) con_op.clear();
-  if(!con_time.empty()) con_time.clear();
+/*********************************************************************
+ Getters of the connections, by their offsets in adjList[id].
+**********************************************************************/
+vector<long unsigned int> node::getConnections(void) {
+  vector<int> &adj = list->adjList[id];
+  return vector<long unsigned int>(adj.begin(), adj.end());
 }
 
-/***********************************************************************
-   This function adds a node $(addId) to the connection list 
-      of the current node.
-   We also stores the opinion value of the connected node, 
-      as well as the the utility it gives the current node;
-      they are given in the input arguments $(add_op) and $(add_ut). 
-   Moreover, the utility of the new connection is added to the 
-      total_utility of the current node.
-************************************************************************/
-void node::addAConnection(long unsigned int addId,
-			  double add_op, double add_ut) {
-  connections.push_back(addId);
-  con_time.push_back(0);  // set the time of connection to zero.
-  con_op.push_back(add_op);
-  utility.push_back(add_ut);
-  total_utility += add_ut; // add to the total utility
+const vector<int> &node::getPartners(void) {return list->adjList[id];}
+
+long unsigned int node::getAConnection(int i) {
+  return list->adjList[id][i];
 }
 
-/***********************************************************************
-   This is one of the two overloaded functions that delete an existing
-     connection.
-   This one deletes a connection by giving the node index of the
-     linked target. (The node index $(delId) is a long unsigned integer.)
-   The return value is an integer, indicating the duration (time steps)
-     when this link remained active.
- ***********************************************************************/ 
-int node::delAConnection(long unsigned int delId) {
-  // First look for the target of deletion via the agent ID.
-  int delOffset = -1;
-  for(int i=0; i<connections.size(); i++) {
-    if(connections[i] == delId) {
-      delOffset = i; // Get the link index in $(delOffset)
-      break;
-    }
-  }
-  if(delOffset == -1) { // Print error messages if such a link is not found.
-    cout << "Error: Attempt to delete a connection to node " << delId << ", which is not in the list." << endl;
-    cout << "       This node " << id << " has " << getNumConnections() << " connections." << endl;
-    //exit(1);
-    return 0;
-  }
-  // delete the id and various data of the disconnected agent.
-  connections.erase(connections.begin()+delOffset);  
-  total_utility -= utility[delOffset];  
-  utility.erase(utility.begin()+delOffset); 
-  con_op.erase(con_op.begin()+delOffset);  
-  int rtn_tmp = con_time[delOffset];
-  con_time.erase(con_time.begin()+delOffset);
-  return(rtn_tmp); // return the duration of connection
+int node::getNumConnections(void) {return list->adjList[id].size();}
+
+vector<double> node::getUtility(void) {
+  int n = getNumConnections();
+  vector<double> ut(n);
+  for(int k=0; k<n; k++)
+    ut[k] = list->linkUtility(id, k);
+  return ut;
 }
 
+double node::getAUtility(int k) {return list->linkUtility(id, k);}
+
+vector<double> node::getConOp(void) {
+  int n = getNumConnections();
+  vector<double> op(n);
+  for(int k=0; k<n; k++)
+    op[k] = list->opinion[list->adjList[id][k]];
+  return op;
+}
+
+double node::getAConOp(int k) {return list->opinion[list->adjList[id][k]];}
+
 /***********************************************************************
-   This is one of the two overloaded functions that delete an existing
-     connection.
-   This one deletes a connection by giving the link index. 
-     (The link index $(delOffset) is an integer.)
-   The return value is an integer, indicating the duration (time steps)
-     when this link remained active.
- ***********************************************************************/ 
-int node::delAConnection(int delOffset) {
-  if(delOffset<0 || delOffset>=connections.size()) {
-    // If link index is out of bound, print the error message.
-    cout << "Error: delete a connection with an offset out of bound." << endl;
+   This function returns the duration (time steps) of a connection,
+     given by its link index $(offset).
+ ***********************************************************************/
+int node::getConTime(int offset) {
+  if(offset<0 || offset>=getNumConnections()) {
+    cout << "Error: get the duration of a connection with an offset out of bound." << endl;
     exit(1);
   }
-  // delete the link and its related data.
-  connections.erase(connections.begin()+delOffset);
-  total_utility -= utility[delOffset];
-  utility.erase(utility.begin()+delOffset);
-  con_op.erase(con_op.begin()+delOffset);
-  int rtn_tmp = con_time[delOffset];
-  con_time.erase(con_time.begin()+delOffset);
-  return(rtn_tmp); // return the duration of connection
+  return list->time_step - list->edges.getSince(list->adjEdge[id][offset]);
 }
 
 /*****************************************************************
   This function checks whether the current node is connected
-    to the node $(nId). 
+    to the node $(nId).
    If not, return -1.
    If it is, return the connection index.
  *****************************************************************/
 int node::checkAConnection(long unsigned int nId) {
-  // First look for the target of deletion via the agent ID.
-  int checkOffset = -1;
-  for(int i=0; i<connections.size(); i++) {
-    if(connections[i] == nId) {
-      checkOffset = i;
-      break;
-    }
-  }
-  return checkOffset;
+  if(nId >= list->adjList.size()) return -1;
+  return list->findLink(id, nId);
 }
 
 /*****************************************************************
   This function returns the utility provided by an existing connection.
   Input:
-        $(getId) is the index of the connection 
+        $(getId) is the index of the connection
   Return value:
         The utility generated by this particular connection.
  *****************************************************************/
 double node::getUtility(long unsigned int getId) {
-  // First look for getId among the connected nodes.
-  int getOffset = -1;
-  int n = connections.size();
-  for(int i=0; i<n; i++) {
-    if(connections[i] == getId) {
-      getOffset = i;
-      break;
-    }
-  }
+  int getOffset = checkAConnection(getId);
   if(getOffset == -1) {
     cout << "Error: Attempt to get the utility with an unconnected node."
 	 << endl;
     exit(1);
   }
   // return the utility of the node.
-  return(utility[getOffset]);  
+  return list->linkUtility(id, getOffset);
 }
 
 /*****************************************************************
   This function returns the opinion of a connected partner.
   Input:
-        $(getId) is the index of the connection. 
+        $(getId) is the index of the connection.
   Return value:
         The opinion of the node linked by this particular connection.
  *****************************************************************/
 double node::getConOp(long unsigned int getId) {
-  // First look for getId among the connected nodes.
-  int getOffset = -1;
-  int n = connections.size();
-  for(int i=0; i<n; i++) {
-    if(connections[i] == getId) {
-      getOffset = i;
-      break;
-    }
-  }
+  int getOffset = checkAConnection(getId);
   if(getOffset == -1) {
     cout << "Error: Attempt to get the connected opinion with an unconnected node."
 	 << endl;
     exit(1);
   }
-  // return the utility of the node.
-  return(con_op[getOffset]);  
+  // return the opinion of the partner.
+  return list->opinion[getId];
 }
-
-/*********************************************************************
-  The subroutine below is incomplete and not currently in use.
-
-   The goal is for this subroutine to update $(total_utility), $(cost), 
-     and $(ut_cost) at once. However, $(cost) requires the knowledge of 
-     the model parameter alpha (par.alpha), which is defined at the
-     nodeList level but not known by each node. It would take some 
-     modifications to pass down the information. We didn't complete this
-     subroutine because we never encountered a situation where we need 
-     to know $(total_utility), $(cost), or $(ut_cost) during a single node 
-     operation. However, we keep it around just in case such a need might
-     arise later. 
-
-   Currently, $(total_utility), $(cost), and $(ut_cost) of each node
-     are updated during the model simulation when network connections
-     are updated in the subroutine updateConnection within ModelC.cxx. 
-**********************************************************************/
-void node::computeTotalUtility(void) {
-  int n = utility.size();
-  total_utility = 0.0;
-  for(int i=0; i<n; i++)
-    total_utility += utility[i];
-  ut_cost = total_utility - cost;
-}
-
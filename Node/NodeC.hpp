@@ -1,11 +1,16 @@
 /* ============================================================
    Header file for the node data class
    -----
-   Brief Summary: Node contains the properties of each unit 
-                  for the simulated population model.
+   Brief Summary: Node is a view of one unit of the simulated
+                  population model. The properties of all nodes
+                  are stored by the nodeList in arrays indexed by
+                  the node (see NodeListC.hpp), and a node refers
+                  to its entries there.
    -----
       variables --
-          id : index of the node
+          list : the nodeList that holds the node
+          id : index of the node in $(list)
+      properties (stored in $(list)) --
           opinion : opinion of the node
           node_type : type of the node (host or guest)
 	  idling : enabling the idling mode (node unchanged in simulation)
@@ -15,9 +20,14 @@
 	  total_utility : total reward received from social connections
           cost : cost for maintaining social connections
           ut_cost : the net utility (total_utility - cost)
-	  con_time : duration of connection (currently not in use)
-       additional -- 
+	  con_time : duration of connection (time steps)
+       additional --
           graphAgent : graphic agents of the node for graphic visualization (see AgentC.hpp for the agent data class)
+   -----
+      A node is only valid while its list is, and reads the current
+        state of the list. The connections are changed by the list
+        only (see addLink and cutLink in ../Model/ModelC.cxx), which
+        keeps both ends of every link in step.
    -----
        Functions and subroutines not defined explicitly here are
           defined in NodeC.cxx.
@@ -30,58 +40,44 @@
 #include"../CCommon.h"
 #include"../Graphics/AgentC.hpp"
 
+class nodeList; // see NodeListC.hpp
+
 class node {
 
 public:
   // Constructor & destructor
-  node(int ntype, double ini_op);
-  ~node(void) { deleteAllConnections(); }
+  node(nodeList *list_ptr, int index): list(list_ptr), id(index) {}
+  ~node(void) {}
   // Getters & setters
   long unsigned int getId(void) {return id;}
-  void setId(long unsigned int value) {id = value;}
-  bool isIdling(void) {return idling;}
-  void setIdling(bool value) {idling = value;}
-  double getOpinion(void) {return opinion;}
-  void setOpinion(double value) {opinion = value;}
-  double getTotalUtility(void) {return total_utility;}
-  double getUtCost(void) {return ut_cost;}
-  double getCost(void) {return cost;}
-  void setCost(double value) {cost = value;}
-  int getNodeType(void) {return node_type;}
-  void setNodeType(int value) {node_type = value;}
-  vector<long unsigned int> getConnections(void) {return connections;}
-  long unsigned int getAConnection(int i) {return connections[i];}
-  int getNumConnections(void) {return connections.size();}
-  vector<double> getUtility(void) {return utility;}
+  bool isIdling(void);
+  void setIdling(bool value);
+  double getOpinion(void);
+  void setOpinion(double value);
+  double getTotalUtility(void);
+  double getUtCost(void);
+  double getCost(void);
+  int getNodeType(void);
+  // The getters returning a vector make a copy; the references and
+  //   the getters by offset ($(k)-th connection) read the list in place.
+  vector<long unsigned int> getConnections(void);
+  const vector<int> &getPartners(void); // indices of the connected nodes
+  long unsigned int getAConnection(int i);
+  int getNumConnections(void);
+  vector<double> getUtility(void);
   double getUtility(long unsigned int getId);
-  vector<double> getConOp(void) {return con_op;}
+  double getAUtility(int k);
+  vector<double> getConOp(void);
   double getConOp(long unsigned int getId);
-  agent getGraphAgent(void) {return graphAgent;}
-  void setGraphAgent(agent value) {graphAgent = value;}
-  // Operators of connections
-  void addAConnection(long unsigned int addId, double add_op, double add_ut);
-  int delAConnection(long unsigned int delId);
-  int delAConnection(int delOffset);
-  void deleteAllConnections(void) { connections.clear(); utility.clear();
-    con_op.clear(); con_time.clear(); }
-  // Note that the above functions of adding/deleting connections only
-  //    add/delete a connection from one end of the connection.
-  // Thus for undirectional connections, the same connection also need
-  //    to be added/deleted from the other end.
+  double getAConOp(int k);
+  const agent &getGraphAgent(void);
+  void setGraphAgent(agent value);
+  int getConTime(int offset);
   int checkAConnection(long unsigned int checkId); // return offset or -1
-  // Compute total utility (incomplete and not currently in use)
-  void computeTotalUtility(void);
+
 private:
+  nodeList *list;
   long unsigned int id;
-  double opinion;
-  int node_type;
-  double total_utility, cost, ut_cost; 
-  bool idling;
-  vector<long unsigned int> connections;
-  vector<double> utility;
-  vector<double> con_op;
-  vector<int> con_time; // duration of connection (currently not in use; see the comments of the subroutine updateConnection in ModelC.cxx.)
-  agent graphAgent;
 };
 
 
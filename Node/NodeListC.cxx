@@ -8,8 +8,12 @@
 	     void linkGuests2RandomHosts
 	     void linkGuests2FractionHosts
 	     void RandomLinks
+	     void addOneNode
+	     void appendNode
+	     int findConnection
 	     void delOneNode
 	     void setGuestsIdling
+	     double layoutScale
 
    Author: Yao-li Chuang
    ============================================================ */
@@ -22,55 +26,60 @@
      guest_ratio - ratio of guest nodes
      nLinkEach - average number of social connections per node
      ini_Op - intensity of opinions (default value=1.0, set in the header file)
+     seed - seed of the random numbers (default value=0: a
+            nondeterministic seed, see RandomC.cxx)
 *************************************************************************/
-nodeList::nodeList(int totalN, double guest_ratio, int nLinkEach, double iniOp)
+nodeList::nodeList(int totalN, double guest_ratio, int nLinkEach, double iniOp,
+		   uint64_t seed)
 {
   // set model parameters
   setDefaultParameters();
+  ut_up2date = false;
+  prefix_up2date = false;
+  events_up2date = false;
 
-  // Reset the random seed using the current time.
-  time_t current_time;
-  srand(static_cast<unsigned>(time(&current_time)));
+  // Set the seed of the random numbers of this list.
+  rng.setSeed(seed);
+  time_step = 0;
+  pool = NULL;
 
   // Creating $(totalN) nodes.
-  if(!memberNodes.empty()) memberNodes.clear(); // first clear the node list
   int i=0, n_host = totalN*(1.0-guest_ratio);
   num_host = n_host; num_guest = totalN-n_host; // numbers of hosts and guests
+  double scale = layoutScale(totalN); // of the discs of the agents
   // Now we begin to initiate a list of host and guest nodes.
   // double dtheta = M_PI*2.0/totalN, theta=0.0; // for putting agents on a circle.
   for(; i<n_host; i++) { // initiating host nodes
     double tmp_op = iniOp; // unified initial opinion
     //double tmp_op = static_cast<double>(rand())
     //               /static_cast<double>(RAND_MAX); // random initial opinion
-    node tmp(1, tmp_op); // creating a host node 
 
     // Here we initial the positions of each node on the graphic display.
     // For further details of how the initial position is set, please see
     //   the comments for the class constructor in AgentC.cxx
     // Simply speaking, the node will be placed randomly on a circular disc.
     vector<double> cxy; // cxy contains the coordinates of the disc center
-    cxy.clear(); cxy.push_back(-60.0); cxy.push_back(0.0); 
-    agent tmp_agent(cxy, 60.0); // for putting agents on a circular disc
+    cxy.clear(); cxy.push_back(-60.0*scale); cxy.push_back(0.0); 
+    agent tmp_agent(cxy, 60.0*scale, rng.uniform(0, i, RNG_AGENT, 0),
+		    rng.uniform(0, i, RNG_AGENT, 1)); // for putting agents on a circular disc
     //agent tmp_agent(theta); // for putting agents on a circle
     //theta += dtheta;
-    tmp.setGraphAgent(tmp_agent); // assigning the graphic agent to the node
-    memberNodes.push_back(tmp); // adding the node to the NodeList
+    appendNode(1, tmp_op, tmp_agent); // adding the host node to the NodeList
   }
   for(; i<totalN; i++) { // initiating guest nodes
     double tmp_op = -iniOp; // unified initial opinion
     //double tmp_op = - static_cast<double>(rand())
     //                 /static_cast<double>(RAND_MAX); // random initial opinion
-    node tmp(-1, tmp_op); // creating a guest node
     // Same as the hosts above, here we put the guests on another circular
     //    disc; note that the host disc centers at (-60, 0), whereas the
-    //    guest disc at (60, 0). 
+    //    guest disc at (60, 0) (both times $(scale)). 
     vector<double> cxy; // cxy contains the coordinates of the disc center
-    cxy.clear(); cxy.push_back(60.0); cxy.push_back(0.0);
-    agent tmp_agent(cxy, 60.0); // for putting agents on a circular disc
+    cxy.clear(); cxy.push_back(60.0*scale); cxy.push_back(0.0);
+    agent tmp_agent(cxy, 60.0*scale, rng.uniform(0, i, RNG_AGENT, 0),
+		    rng.uniform(0, i, RNG_AGENT, 1)); // for putting agents on a circular disc
     //agent tmp_agent(theta); // for putting agents on a circle
     //theta += dtheta;
-    tmp.setGraphAgent(tmp_agent); // assigning the graphic agent to the node
-    memberNodes.push_back(tmp); // adding the node to the NodeList
+    appendNode(-1, tmp_op, tmp_agent); // adding the guest node to the NodeList
   }
 
   // Here we make the initial social connections for the nodes that we
@@ -120,20 +129,27 @@ nodeList::nodeList(int totalN, double guest_ratio, int nLinkEach, double iniOp)
      guestN - number of guest nodes 
      nLinkEach - average number of social connections per node
      ini_Op - intensity of opinions (default value=1.0, set in the header file)
+     seed - seed of the random numbers (default value=0: a
+            nondeterministic seed, see RandomC.cxx)
 *************************************************************************/
-nodeList::nodeList(int totalN, int guestN, int nLinkEach, double iniOp) {
+nodeList::nodeList(int totalN, int guestN, int nLinkEach, double iniOp,
+		   uint64_t seed) {
 
   // set model parameters
   setDefaultParameters();
+  ut_up2date = false;
+  prefix_up2date = false;
+  events_up2date = false;
 
-  // Reset the random seed using the current time.
-  time_t current_time;
-  srand(static_cast<unsigned>(time(&current_time)));
+  // Set the seed of the random numbers of this list.
+  rng.setSeed(seed);
+  time_step = 0;
+  pool = NULL;
 
   // Creating $(totalN) nodes.
-  if(!memberNodes.empty()) memberNodes.clear();
   int i=0, n_host = totalN - guestN;
   num_host = n_host; num_guest = guestN;
+  double scale = layoutScale(totalN); // of the discs of the agents
 
   // Now we begin to initiate a list of host and guest nodes.
   //double dtheta = M_PI*2.0/totalN, theta=0.0; // for putting agents on a circle.
@@ -141,27 +157,25 @@ nodeList::nodeList(int totalN, int guestN, int nLinkEach, double iniOp) {
     double tmp_op = iniOp; // unified initial opinion
     //double tmp_op = static_cast<double>(rand())
     //               /static_cast<double>(RAND_MAX); // random initial opinion
-    node tmp(1, tmp_op);
     vector<double> cxy;
-    cxy.clear(); cxy.push_back(-50.0); cxy.push_back(0.0);
-    agent tmp_agent(cxy, 60.0);
+    cxy.clear(); cxy.push_back(-50.0*scale); cxy.push_back(0.0);
+    agent tmp_agent(cxy, 60.0*scale, rng.uniform(0, i, RNG_AGENT, 0),
+		    rng.uniform(0, i, RNG_AGENT, 1));
     //agent tmp_agent(theta); // for putting agents on a circle.
     //theta += dtheta;
-    tmp.setGraphAgent(tmp_agent);
-    memberNodes.push_back(tmp);
+    appendNode(1, tmp_op, tmp_agent);
   }
   for(; i<totalN; i++) { // initiating guest nodes
     double tmp_op = -iniOp; // unified initial opinion
     //double tmp_op = - static_cast<double>(rand())
     //                 /static_cast<double>(RAND_MAX); // random initial opinion
-    node tmp(-1, tmp_op);
     vector<double> cxy;
-    cxy.clear(); cxy.push_back(50.0); cxy.push_back(0.0);
-    agent tmp_agent(cxy, 20.0);
+    cxy.clear(); cxy.push_back(50.0*scale); cxy.push_back(0.0);
+    agent tmp_agent(cxy, 20.0*scale, rng.uniform(0, i, RNG_AGENT, 0),
+		    rng.uniform(0, i, RNG_AGENT, 1));
     //agent tmp_agent(theta); // for putting agents on a circle.
     //theta += dtheta;
-    tmp.setGraphAgent(tmp_agent);
-    memberNodes.push_back(tmp);
+    appendNode(-1, tmp_op, tmp_agent);
   }
   
   if(nLinkEach != 0) {
@@ -214,7 +228,7 @@ nodeList::nodeList(int totalN, int guestN, int nLinkEach, double iniOp) {
 **********************************************************************/
 void nodeList::setNeighborConnections(int nLinkEach, int n_host)
 {
-  int n = memberNodes.size();
+  int n = adjList.size();
   int st = -nLinkEach/2;
   int ed = st+nLinkEach;
   // Connect host nodes with neighboring host nodes
@@ -226,16 +240,8 @@ void nodeList::setNeighborConnections(int nLinkEach, int n_host)
       else if(j<0) j2=j+n_host;
       else if(j>=n_host) j2=j-n_host;
       else j2 = j;
-      vector<double> tmp_op; tmp_op.clear();
-      tmp_op.push_back(memberNodes[j2].getOpinion()); // tmp_op[0] is the opinion of node j2
-      tmp_op.push_back(memberNodes[i].getOpinion()); // tmp_op[1] is the opinion of node i
-      // Computing the utility
-      vector<double> tmp_ut = utilityFunction(memberNodes[i].getNodeType(),
-					      tmp_op[1],
-					      memberNodes[j2].getNodeType(),
-					      tmp_op[0]);
-      memberNodes[i].addAConnection(memberNodes[j2].getId(), tmp_op[0], tmp_ut[0]);  // tmp_ut[0] is the utility node j2 gives node i
-      memberNodes[j2].addAConnection(memberNodes[i].getId(), tmp_op[1], tmp_ut[1]);  // tmp_ut[1] is the utility node i gives node j2
+      adjList[i].push_back(j2); // the utilities are set by createUtMatrix
+      adjList[j2].push_back(i);
     }
 
   // Connect guest nodes to neighboring guest nodes
@@ -247,15 +253,8 @@ void nodeList::setNeighborConnections(int nLinkEach, int n_host)
       else if(j<n_host) j2=j-n_host+n;
       else if(j>=n) j2=j-n+n_host;
       else j2=j;
-      vector<double> tmp_op; tmp_op.clear();
-      tmp_op.push_back(memberNodes[j2].getOpinion());
-      tmp_op.push_back(memberNodes[i].getOpinion());
-      vector<double> tmp_ut = utilityFunction(memberNodes[i].getNodeType(),
-					      tmp_op[1],
-					      memberNodes[j2].getNodeType(),
-					      tmp_op[0]);
-      memberNodes[i].addAConnection(memberNodes[j2].getId(), tmp_op[0], tmp_ut[0]);
-      memberNodes[j2].addAConnection(memberNodes[i].getId(), tmp_op[1], tmp_ut[1]);
+      adjList[i].push_back(j2); // the utilities are set by createUtMatrix
+      adjList[j2].push_back(i);
     }
   */
 }
@@ -277,50 +276,43 @@ void nodeList::rewireInitialConnections(int ifirst,
   int iend = ifirst+n_node; 
   // Loop through the nodes to rewire the connections
   for(int i=ifirst; i<iend; i++) {
-    int n_link = memberNodes[i].getNumConnections(); // get the number of existing connections of node i.
+    int n_link = adjList[i].size(); // get the number of existing connections of node i.
+    int draw = 0; // index of the random numbers drawn for node i
     // Loop through the connections to determin whether and to which node
     //    an existing link would be rewired.
     for(int j=0; j<n_link; j++) { 
-      double tmp = static_cast<double>(rand())/static_cast<double>(RAND_MAX); // 0 <= tmp < 1 is a random number to determine whether link j should be rewired.
+      double tmp = rng.uniform(0, i, RNG_REWIRE, draw++); // 0 <= tmp < 1 is a random number to determine whether link j should be rewired.
       if(tmp<=rw_prob) { // Rewire link j
 	// First we have to find where link j is connected and cut the link
-	long unsigned int jid = memberNodes[i].getAConnection(j); // jid is the index of the connected node of link j from node i
-	// Here we look for this connected node using the index jid.
-	int jcnt=-1;
-	for(int k=ifirst; k<iend; k++)
-	  if(memberNodes[k].getId()==jid) { jcnt=k; break; }
+	int jid = adjList[i][j]; // jid is the index of the connected node of link j from node i
+	// The id of a node is its index, so node jid is found directly
+	//   if it is in the group.
+	int jcnt = (jid>=ifirst && jid<iend) ? jid : -1;
 	if(jcnt==-1) { // Print error messages if no such node is found.
 	  cout << "Error in rewireInitialConnections (NodeListC.cxx)" << endl;
-	  cout << "iid= " << memberNodes[i].getId();
+	  cout << "iid= " << i;
 	  cout << ", jid= " << jid << ", n_link = " << n_link << endl;
 	  exit(1);
 	}
 	// Note that the link is stored in both connected nodes, so we have
         //    to delete it from both ends.
-	memberNodes[jcnt].delAConnection(memberNodes[i].getId());
-	memberNodes[i].delAConnection(j);
+	adjList[jcnt].erase(adjList[jcnt].begin()+findConnection(jcnt, i));
+	adjList[i].erase(adjList[i].begin()+j);
 	
 	// Connect to another node that is not already connected
 	for(int check_connection=0; check_connection!=-1;) {
-	  tmp = static_cast<double>(rand())/static_cast<double>(RAND_MAX);
+	  tmp = rng.uniform(0, i, RNG_REWIRE, draw++);
 	  int k = static_cast<int>(static_cast<double>(n_node)*tmp) + ifirst;
 	  if(k<ifirst) k=k+n_node;
 	  else if(k>=iend) k=k-n_node;
+	  if(k==i) continue;  // do it again if k=i (no link to itself).
 	  check_connection =
-	    memberNodes[i].checkAConnection(memberNodes[k].getId());
+	    findConnection(i, k);
 	  // check_connection will return -1 when node k is not currently
           //   connected to node i.
 	  if(check_connection==-1) {
-	    vector<double> tmp_op; tmp_op.clear();
-	    tmp_op.push_back(memberNodes[k].getOpinion()); // tmp_op[0] is the opinion of node k
-	    tmp_op.push_back(memberNodes[i].getOpinion()); // tmp_op[1] is the opinion of node i
-	    // Compute the utility
-	    vector<double> ut_tmp = utilityFunction(memberNodes[i].getNodeType(),
-						    tmp_op[1],
-						    memberNodes[k].getNodeType(),
-						    tmp_op[0]);
-	    memberNodes[i].addAConnection(memberNodes[k].getId(), tmp_op[0], ut_tmp[0]); // ut_tmp[0] is the utility node k gives node i
-	    memberNodes[k].addAConnection(memberNodes[i].getId(), tmp_op[1], ut_tmp[1]); // ut_tmp[1] is the utility node i gives node k
+	    adjList[i].push_back(k); // the utilities are set by createUtMatrix
+	    adjList[k].push_back(i);
 	  }
 	} // end of for(check_connection) loop
       } // end of if(tmp<=rw_prob) loop
@@ -337,31 +329,26 @@ void nodeList::rewireInitialConnections(int ifirst,
  ***********************************************************************/
 void nodeList::linkGuests2RandomHosts(int nLinkEach, int n_host)
 {
-  int n = memberNodes.size(); // total number of nodes
+  int n = adjList.size(); // total number of nodes
   // Connect host nodes with neighboring host nodes
   int i=n_host;
-  for(; i < n; i++) // looping through the guest nodes
+  for(; i < n; i++) { // looping through the guest nodes
+    int draw = 0; // index of the random numbers drawn for node i
     for(int j=0; j<nLinkEach; j++) { // Each guest node is linked to $(nLinkEach) host nodes.
       for(int check_connection=0; check_connection!=-1;) {
-	double tmp = static_cast<double>(rand())/static_cast<double>(RAND_MAX);
+	double tmp = rng.uniform(0, i, RNG_LINK, draw++);
 	int k = static_cast<int>(static_cast<double>(n_host)*tmp);
 	if(k<0) k=k+n_host;
 	else if(k>=n_host) k=k-n_host;
 	check_connection =
-	  memberNodes[i].checkAConnection(memberNodes[k].getId());
+	  findConnection(i, k);
 	if(check_connection==-1) {
-	  vector<double> tmp_op; tmp_op.clear();
-	  tmp_op.push_back(memberNodes[k].getOpinion());
-	  tmp_op.push_back(memberNodes[i].getOpinion());
-	  vector<double> ut_tmp = utilityFunction(memberNodes[i].getNodeType(),
-						  tmp_op[1],
-						  memberNodes[k].getNodeType(),
-						  tmp_op[0]);
-	  memberNodes[i].addAConnection(memberNodes[k].getId(), tmp_op[0], ut_tmp[0]);
-	  memberNodes[k].addAConnection(memberNodes[i].getId(), tmp_op[1], ut_tmp[1]);
+	  adjList[i].push_back(k); // the utilities are set by createUtMatrix
+	  adjList[k].push_back(i);
 	}
       } // end of for(check_connection) loop
     } // end of j loop for nLink
+  } // end of i loop
 }
 
 /***********************************************************************
@@ -372,49 +359,54 @@ void nodeList::linkGuests2RandomHosts(int nLinkEach, int n_host)
        $(n_host) is the number of host nodes. 
        $(h_frac) defines the fraction of links to host nodes
    No return values.
+  -----
+   Note: While the initial network is built, the links are only
+         listed in adjList (see createAdjMatrix). Once the lists of
+         links exist, they are added by addLink, as in
+         evolveAdjMatrix, so the slots, the tallies, and the
+         utilities stay in step with adjList.
  **********************************************************************/
 
 void nodeList::linkGuests2FractionHosts(int nLinkEach, int n_host, double hfrac)
 {
-  int n = memberNodes.size();
+  int n = adjList.size();
+  bool built = (adjEdge.size() == adjList.size());
   // Connect host nodes with neighboring host nodes
   int n_guest = n-n_host;
   int h_link = nLinkEach*hfrac;
   int g_link = nLinkEach - h_link;
   int i=n_host;
-  for(; i < n; i++)
+  for(; i < n; i++) {
+    int draw = 0; // index of the random numbers drawn for node i
     for(int j=0; j<nLinkEach; j++) {
       for(int check_connection=0; check_connection!=-1;) {
 	int k;
 	if(j<h_link) {
-	  double tmp = static_cast<double>(rand())
-	              /static_cast<double>(RAND_MAX);
+	  double tmp = rng.uniform(time_step, i, RNG_LINK, draw++);
 	  k = static_cast<int>(static_cast<double>(n_host)*tmp);
 	  if(k<0) k=k+n_host;
 	  else if(k>=n_host) k=k-n_host;
 	} else {
-	  double tmp = static_cast<double>(rand())
-	              /static_cast<double>(RAND_MAX);
+	  double tmp = rng.uniform(time_step, i, RNG_LINK, draw++);
 	  k = n_host + static_cast<int>(static_cast<double>(n_guest)*tmp);
 	  if(k<n_host) k=k+n_guest;
 	  else if(k>=n) k=k-n_guest;
 	  if(k==i) continue;
 	}
 	check_connection =
-	  memberNodes[i].checkAConnection(memberNodes[k].getId());
-	if(check_connection==-1) {
-	  vector<double> tmp_op; tmp_op.clear();
-	  tmp_op.push_back(memberNodes[k].getOpinion());
-	  tmp_op.push_back(memberNodes[i].getOpinion());
-	  vector<double> ut_tmp = utilityFunction(memberNodes[i].getNodeType(),
-						  tmp_op[1],
-						  memberNodes[k].getNodeType(),
-						  tmp_op[0]);
-	  memberNodes[i].addAConnection(memberNodes[k].getId(), tmp_op[0], ut_tmp[0]);
-	  memberNodes[k].addAConnection(memberNodes[i].getId(), tmp_op[1], ut_tmp[1]);
+	  findConnection(i, k);
+	if(check_connection==-1 && built) {
+	  double ut_ik, ut_ki;
+	  utilityPair(i, k, ut_ik, ut_ki);
+	  addLink(i, k, ut_ik, ut_ki);
+	} else if(check_connection==-1) {
+	  adjList[i].push_back(k); // the utilities are set by createUtMatrix
+	  adjList[k].push_back(i);
 	}
       } // end of for(check_connection) loop
     } // end of j loop for nLink
+  } // end of i loop
+  if(built) events_up2date = false; // changes not made by the events
 }
 
 /*********************************************************************
@@ -430,52 +422,133 @@ void nodeList::linkGuests2FractionHosts(int nLinkEach, int n_host, double hfrac)
  *********************************************************************/
 void nodeList::RandomLinks(int nLinkEach)
 {
-  int n = memberNodes.size(); // get the total number of nodes.
+  int n = adjList.size(); // get the total number of nodes.
   // Create social connections for each node.
-  for(int i=0; i < n; i++)
+  for(int i=0; i < n; i++) {
+    int draw = 0; // index of the random numbers drawn for node i
     for(int j=0; j<nLinkEach/2; j++) { // making $(nLinkEach)/2 connections
       // We randomly pick a node with index k (0 <= k < n) to connect.
       // However, if k=i itself, or k is already connected to i, we will
       //   pick another index until we find a node k that is not yet
       //   connected to node i. 
       for(int check_connection=0; check_connection!=-1;) {
-	double tmp = static_cast<double>(rand())/static_cast<double>(RAND_MAX);
+	double tmp = rng.uniform(0, i, RNG_LINK, draw++);
 	int k = static_cast<int>(static_cast<double>(n)*tmp); 
 	if(k<0) k=k+n;
 	else if(k>=n) k=k-n;
 	if(i==k) continue;  // do it again if k=i.
 	check_connection =
-	  memberNodes[i].checkAConnection(memberNodes[k].getId());
+	  findConnection(i, k);
 	// check_connection will return -1 when node k is not currently
         //   connected to node i.
 	if(check_connection==-1) {
-	  vector<double> tmp_op; tmp_op.clear();
-	  tmp_op.push_back(memberNodes[k].getOpinion()); // tmp_op[0] is opinion of node k
-	  tmp_op.push_back(memberNodes[i].getOpinion()); // tmp_op[1] is opinion of node i
-          // Computing the utility
-	  vector<double> ut_tmp = utilityFunction(memberNodes[i].getNodeType(),
-						  tmp_op[1],
-						  memberNodes[k].getNodeType(),
-						  tmp_op[0]);
-	  memberNodes[i].addAConnection(memberNodes[k].getId(), tmp_op[0], ut_tmp[0]); // ut_tmp[0] is the utility node k gives node i
-	  memberNodes[k].addAConnection(memberNodes[i].getId(), tmp_op[1], ut_tmp[1]); // ut_tmp[1] is the utilit node i gives node k
+	  adjList[i].push_back(k); // the utilities are set by createUtMatrix
+	  adjList[k].push_back(i);
 	}
       } // end of for(check_connection) loop
     } // end of j loop for nLink
+  } // end of i loop
+}
+
+/*********************************************************************
+  This subroutine adds one node with no connections to the end of
+    the list. Its graphic agent is placed on the disc of its type,
+    as in the first constructor (for the list with the new node).
+  Input values:
+     $(ntype) is the type of the node (+1: host, -1: guest).
+     $(ini_op) is the initial opinion of the node.
+  -----
+  Note: The hosts must precede the guests in the list (see
+        utilityPair in NodeListC.hpp), so a host cannot be added
+        after a guest.
+ *********************************************************************/
+void nodeList::addOneNode(int ntype, double ini_op) {
+  if(ntype==1 && num_guest>0) {
+    cout << "Error: a host node must be added before the guest nodes." << endl;
+    exit(1);
+  }
+  int i = opinion.size();
+  vector<double> cxy;
+  double scale = layoutScale(i+1); // of the discs of the agents
+  cxy.push_back(ntype==1 ? -60.0*scale : 60.0*scale); cxy.push_back(0.0);
+  agent tmp_agent(cxy, 60.0*scale, rng.uniform(time_step, i, RNG_AGENT, 0),
+		  rng.uniform(time_step, i, RNG_AGENT, 1));
+  appendNode(ntype, ini_op, tmp_agent);
+  if(ntype==1) num_host++;
+  else num_guest++;
+  dist_up2date = false;
+}
+
+/*********************************************************************
+  This subroutine appends the entries of a new node to the arrays
+    of the list. The id of a node is its index in the list.
+  Input values:
+     $(ntype) is the type of the node (+1: host, -1: guest).
+     $(ini_op) is the initial opinion of the node.
+     $(graph_agent) is the graphic agent of the node.
+ *********************************************************************/
+void nodeList::appendNode(int ntype, double ini_op, agent graph_agent) {
+  opinion.push_back(ini_op);
+  node_type.push_back(ntype);
+  idling.push_back(false);
+  cost.push_back(linkCost(0));
+  total_utility.push_back(0.0);
+  agents.push_back(graph_agent);
+  adjList.push_back(vector<int>());
+  adjEdge.push_back(vector<int>());
+  num_link.push_back(0);
+  prefix_up2date = false;
+  events_up2date = false;
+}
+
+/*********************************************************************
+  This function looks for node $(j) among the partners of node $(i)
+    by a linear search, since adjList[i] is not sorted yet while
+    the initial network is built (see findLink in ModelC.cxx for
+    the sorted lists).
+  Return value:
+     the offset of $(j) in adjList[i], or -1 if they are not linked.
+ *********************************************************************/
+int nodeList::findConnection(int i, int j) {
+  for(size_t k=0; k<adjList[i].size(); k++)
+    if(adjList[i][k] == j) return k;
+  return -1;
 }
 
 /*********************************************************************
   This subroutine delete one node from the node list
   Input values:
      $(i) is the index of the node to be deleted.
+  -----
+  The links of node i are removed, and the nodes after it move
+    one index down. The list of links is then made again, so the
+    durations of the remaining connections restart from zero.
  *********************************************************************/
 void nodeList::delOneNode(int i) {
-  if(i>=0 && i<memberNodes.size())
-    memberNodes.erase(memberNodes.begin()+i);
-  else {
+  int n = opinion.size();
+  if(i<0 || i>=n) {
     cout << "Error: Delete a node out of bound." << endl;
     exit(1);
   }
+  for(size_t k=0; k<adjList[i].size(); k++) { // removing the links of node i
+    vector<int> &adj = adjList[adjList[i][k]];
+    adj.erase(find(adj.begin(), adj.end(), i));
+  } // end of k loop
+  if(node_type[i]==1) num_host--;
+  else num_guest--;
+  opinion.erase(opinion.begin()+i);
+  node_type.erase(node_type.begin()+i);
+  idling.erase(idling.begin()+i);
+  cost.erase(cost.begin()+i);
+  total_utility.erase(total_utility.begin()+i);
+  agents.erase(agents.begin()+i);
+  adjList.erase(adjList.begin()+i);
+  for(int j=0; j<n-1; j++) // renumbering the partners after node i
+    for(size_t k=0; k<adjList[j].size(); k++)
+      if(adjList[j][k] > i) adjList[j][k]--;
+  createAdjMatrix();
+  createUtMatrix();
+  updateConnection();
 }
 
 /*********************************************************************
@@ -488,5 +561,17 @@ void nodeList::delOneNode(int i) {
 void nodeList::setGuestsIdling(bool value) {
   int ntot=num_host+num_guest;
   for(int i=num_host; i<ntot; i++)
-    memberNodes.at(i).setIdling(value);
+    idling.at(i) = value;
+  events_up2date = false;
+}
+
+/************************************************************************
+  This function returns the factor by which the discs of the graphic
+    agents, and their centers, are enlarged for $(n) nodes: the discs
+    are drawn for up to 500 nodes, and grow with sqrt(n) beyond, so
+    that the agents are no more crowded within the range of their
+    repulsion (see GraphModelC.cxx) however many nodes there are.
+*************************************************************************/
+double nodeList::layoutScale(int n) {
+  return sqrt(max(1.0, n/500.0));
 }
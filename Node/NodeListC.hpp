@@ -11,24 +11,69 @@
         <<Basic>>
           num_host : number of host nodes
           num_guest : number of guest nodes
-          memberNodes : the list of nodes
+          opinion, node_type, idling, cost, total_utility :
+                   the properties of the nodes, one entry per node
+                   (see NodeC.hpp; node i is a view of entries i)
+          agents : graphic agents of the nodes
+          rng : random number generator of this list (see RandomC.hpp)
+          time_step : number of time steps simulated so far
+                      (part of the counter of the random numbers)
+          pool : pool of threads running the opinion updates and
+                 the evolution of links
+                 (NULL runs them serially; not owned by the list)
 	<<For the population model>>
           par : parameter values of the population model
-	  adjMatrix : adjacency matrix
+          utc : constants of the utility function computed from $(par)
+          ec : the same constants by the tag of links in $(edges)
+          cost_table : cost of maintaining k links, exp(k/alpha)
+	  adjList : sparse adjacency lists (sorted indices of the
+                    linked partners of each node; while the initial
+                    network is built, in the order the links are
+                    made, see createAdjMatrix)
           num_link : the number of links of each node
-          utMatrix : utility matrix
-	<<For graphic display>>
-          forceMatrix : force matrix
+          adjEdge : slots in $(edges) of the links listed in adjList
+          edges : list of links, with the utilities of both ends
+                  (see EdgeListC.hpp)
+          ut_up2date : flag of whether the utilities are up-to-date
+          op_ut : opinions of the nodes when the utilities of their
+                  links were last recomputed (empty: all links need
+                  recomputing, see updateUtMatrix)
+          op_dirty : flag of whether each node has moved from $(op_ut)
+          dirty_slots : slots of the links of the dirty nodes
+          ut_prefix : running sums of the utilities of the links of
+                      each node, in the order of adjList, for
+                      sampling a partner (see updateUtPrefix)
+          prefix_start : offset of the sums of node i in $(ut_prefix)
+          prefix_up2date : flag of whether $(ut_prefix) is up-to-date
+          link_count : number of host-host, host-guest, and guest-guest
+                       links (counted from both ends)
+          link_rw : rewards from host-host, host-guest, and guest-guest
+                    links (counted from both ends)
+	<<For the event-driven engine>>
+          events : times of the next opinion update (event 2i) and
+                   link proposal (event 2i+1) of each node i
+                   (see EventQueueC.hpp)
+          event_rate : rate of each event
+          event_time : time of the current event (continued
+                       from one time step to the next)
+          event_draw : number of random numbers drawn by each node
+                       in the current time step
+          n_cuttable : number of links that each node would cut
+                       if proposed
+          saturated : flag of whether each node would add no link
+          n_active : number of nodes not idling
+          events_up2date : flag of whether the events are up-to-date
 	<<For statistics>>
 	  stats : statistics data of the network
-          distMatrix : distance matrix
+          distMatrix : distance matrix (n^2 entries, only within
+                       the budget $(par.dense_mb))
           distHistogram : histogram of distance distribution
 	  dist_up2date : flag of whether distMatrix is up-to-date
    -----
        Functions and subroutines not defined explicitly here are
-          defined in one of the 4 files: NodeListC.cxx, 
-          ../Model/ModelC.cxx, ../Graphics/GraphModelC.cxx, 
-          and ../Stats/StatC.cxx:
+          defined in one of the 6 files: NodeListC.cxx, 
+          CheckpointC.cxx, ../Model/ModelC.cxx, ../Model/EventC.cxx,
+          ../Graphics/GraphModelC.cxx, and ../Stats/StatC.cxx:
 	  <<NodeListC.cxx>>
 	     the contructors
              setNeighborConnections
@@ -36,36 +81,76 @@
 	     linkGuests2RandomHosts
 	     linkGuests2FractionHosts
 	     RandomLinks
+	     addOneNode
+	     appendNode
+	     findConnection
 	     delOneNode
 	     setGuestsIdling
+	     layoutScale
+	  <<CheckpointC.cxx>>
+	     the constructor from a checkpoint
+	     writeCheckpoint
 	  <<ModelC.cxx>>
              setDefaultParameters
 	     resetParametersFromFile
 	     changeParameter
+	     isParameter
 	     hostInitiation
 	     nextTimeStep
 	     createAdjMatrix
 	     createUtMatrix
+	     findLink
+	     addLink
+	     cutLink
+	     insertLink
+	     eraseLink
+	     compactEdges
+	     linkType
+	     forEachRange
+	     forEachNodeRange
 	     updateUtMatrix
+	     verifyUtMatrix
+	     updateUtPrefix
+	     samplePartner
 	     updateOpinion
 	     updateOpinion2
 	     updateOpinionGuest
 	     updateOpinion2Guest
 	     utilityFunction
+	     setUtilityConstants
+	     setCostTable
+	     denseFits
 	     evolveAdjMatrix
+	     selectCandidate
+	     evolveOneLink
+	     decideLink
+	     evolveAdjMatrixSync
 	     updateConnection
+	  <<EventC.cxx>>
+	     runEvents
+	     initEvents
+	     opinionEvent
+	     linkEvent
+	     opinionRate
+	     linkRate
+	     cutAccepted
+	     countCuttable
+	     setEventRate
 	  <<GraphModelC.cxx>>
 	     updateGraphData
-	     createForceMatrix
-	     updateForceMatrix
+	     writeSnapshot
+	     updateForces
 	     updatePosition
 	     forceFunction
 	     repulsionFunction
 	  <<StatC.cxx>>
 	     computeStats
+	     writeStatsHeader
+	     writeStats
+	     getStatsNames
+	     getStatsValues
 	     updateDistMatrix
-	     algorithmDijkstra
-	     minDistance
+	     breadthFirstSearch
 	     numCluster
 	     degreeConnectionSnapshot
 
@@ -76,6 +161,14 @@
 
 #include"../CCommon.h"
 #include"NodeC.hpp"
+#include"RandomC.hpp"
+#include"EdgeListC.hpp"
+#include"../Model/EventQueueC.hpp"
+#include<functional>
+#include<atomic>
+
+class threadPool; // see ../Parallel/ThreadPoolC.hpp
+struct graphSnapshot; // see ../Graphics/SnapshotC.hpp
 
 
 /**************************************************************
@@ -100,10 +193,32 @@ struct modelParameters {
   double welfare;
   bool enable_op;  // enable or disable the change of opinions
   bool enable_net; // enable or disable the change of connections
+  bool sync_net;   // change the connections of all nodes synchronously
+  bool fast_exp;   // use fastExp in the utility function (see EdgeListC.hpp)
+  bool event_driven; // run the events in continuous time (see EventC.cxx;
+                     //   faster only when the opinions do not move)
+  double ut_epsilon; // change of opinion that makes a node dirty (see updateUtMatrix)
+  bool ut_verify;    // check updateUtMatrix against a full recomputation
+  double dense_mb; // memory budget (MB) of each n x n matrix (see denseFits)
   // The next 2 are not currently implemented.
   double ini_hlink_frac; // initial fraction of host connections per node (currently not in use, may belong to the initial conditions in Main.cxx)
 };
 
+/**************************************************************
+  The constants of the utility function, computed from the model
+    parameters by setUtilityConstants (ModelC.cxx) ---
+     A_same: A of links between nodes of the same type (AH)
+     A_cross: A of links between hosts and guests (AG)
+     inv_h, inv_g: 1/(2 sigmaH) and 1/(2 sigmaG), by which the
+                   squared difference of opinions is multiplied
+                   in the exponent of the utility of a host and
+                   of a guest
+ **************************************************************/
+struct utilityConstants {
+  double A_same, A_cross;
+  double inv_h, inv_g;
+};
+
 /**************************************************************
   The statistical data that we compute ---
      avg_link: average number of links per node (4 entries: overall, 
@@ -113,15 +228,37 @@ struct modelParameters {
      avg_ut: average utility per node (3 entries: overall, host, guest)
      avg_rw: average reward per link (4 entries: overall, host2host,
              guest2guest, host2guest)
+  and the indicators derived from them ---
+     integration: indicator of guest integration, the fraction of
+                  guest links to hosts relative to the host fraction
+     ut_ratio: guest utility compared to host utility
+     rw_cross: rewards through host-guest links compared to the
+               fair share
  **************************************************************/
 struct modelStats {
   vector<double> avg_link; // number of links; total, h2h, h2g, g2h, g2g
   vector<double> avg_op; //opinion; total, h, g
   vector<double> avg_ut; //utility; total, h, g  
   vector<double> avg_rw; //reward; total, hh, gg, hg
+  double integration, ut_ratio, rw_cross; // derived indicators
 };
 
 
+/**************************************************************
+  The streams of random numbers, i.e., what they are used for.
+  Together with the time step, the node index, and the index of
+    the draw, they make the counter of philoxRandom, so that
+    every draw of a run is defined by the seed alone.
+ **************************************************************/
+enum randomStream {
+  RNG_AGENT,   // initial positions of the graphic agents
+  RNG_REWIRE,  // rewireInitialConnections
+  RNG_LINK,    // linkGuests2RandomHosts, linkGuests2FractionHosts, RandomLinks
+  RNG_EVOLVE,  // evolveAdjMatrix
+  RNG_OPINION, // updateOpinion2, updateOpinion2Guest
+  RNG_EVENT    // the event-driven engine (EventC.cxx)
+};
+
 /**************************************************************
    nodeList data class
  **************************************************************/
@@ -130,35 +267,57 @@ class nodeList {
 public:
   // Constructors & destructor
   // The difference between the 2 constructors is whether the guest nodes are specified by a ratio or by a number
-  nodeList(int totalN, double guest_ratio, int nLinkEach, double iniOp=1.0);
-  nodeList(int totalN, int guestN, int nLinkEach, double iniOp=1.0);
-  ~nodeList(void) { memberNodes.clear(); adjMatrix.clear(); num_link.clear();
-    utMatrix.clear(); forceMatrix.clear(); distMatrix.clear();}
+  // A seed of 0 draws a random seed (see RandomC.cxx).
+  nodeList(int totalN, double guest_ratio, int nLinkEach, double iniOp=1.0,
+	   uint64_t seed=0);
+  nodeList(int totalN, int guestN, int nLinkEach, double iniOp=1.0,
+	   uint64_t seed=0);
+  nodeList(string file_name); // from a checkpoint, in CheckpointC.cxx
+  ~nodeList(void) { opinion.clear(); agents.clear(); adjList.clear();
+    num_link.clear(); adjEdge.clear(); distMatrix.clear();}
   // Getters
-  vector<node> getMemberNodes(void) {return memberNodes;}
-  int getNumMemberNodes(void) {return memberNodes.size();}
+  // The references are read-only and valid until the list changes.
+  node getNode(int i) {return node(this, i);} // a view, nothing allocated
+  int getNumMemberNodes(void) {return opinion.size();}
+  const vector<double> &getOpinions(void) {return opinion;}
+  const vector<int> &getNodeTypes(void) {return node_type;}
+  const vector<agent> &getGraphAgents(void) {return agents;}
   int getNumHost(void) {return num_host; }
   int getNumGuest(void) {return num_guest; }
-  // Adding or deleting nodes
-  void addOneNode(node value) {memberNodes.push_back(value);}
-  void delOneNode(int i); // in NodeListC.cxx
+  uint64_t getSeed(void) {return rng.getSeed(); }
+  long int getTimeStep(void) {return time_step; }
+  // Setters
+  // The pool must outlive its use by the list; NULL runs serially.
+  void setThreadPool(threadPool *value) {pool = value;}
+  // For checkpoints (CheckpointC.cxx)
+  bool writeCheckpoint(string file_name);
+  // Adding or deleting nodes (NodeListC.cxx)
+  void addOneNode(int ntype, double ini_op); // with no connections
+  void delOneNode(int i);
   // For initiating connections
   void linkGuests2FractionHosts(int nLinkEach, int n_host, double hfrac); // in NodeListC.cxx
   double hostInitiation(void); // in ModelC.cxx
   // For model parameters (ModelC.cxx)
-  void resetParametersFromFile(string file_name);
+  void resetParametersFromFile(string file_name, bool verbose=true);
   void changeParameter(string pname, double value);
   void changeParameter(string pname, bool value);
+  static int isParameter(string pname); // 1: real, 2: logical, 0: unknown
   // For running the model simulation (ModelC.cxx)
   void nextTimeStep(void);
   vector<double> utilityFunction(int ntype1, double x1, int ntype2, double x2);
-  // For graphic display (GraphModelC.cxx)
+  // For graphic display (GraphModelC.cxx); not called by nextTimeStep
   void updateGraphData(void);
+  void writeSnapshot(graphSnapshot &snap);
+  static double layoutScale(int n); // of the initial discs, in NodeListC.cxx
   // For statistics (StatC.cxx)
   void computeStats(void);
-  struct modelStats getStats(void) {return stats;}
+  const struct modelStats &getStats(void) {return stats;}
+  static void writeStatsHeader(ostream &out);
+  void writeStats(ostream &out);
+  static vector<string> getStatsNames(void); // fields of getStatsValues
+  void getStatsValues(vector<double> &values);
   bool IsDistMatrixUpdated(void) {return dist_up2date;}
-  vector<int> getDistHistogram(void) {
+  const vector<int> &getDistHistogram(void) {
     if(!IsDistMatrixUpdated())
       updateDistMatrix();
     return distHistogram;
@@ -167,11 +326,43 @@ public:
   vector<int> degreeConnectionSnapshot(int n_degree);
 
 private:
+  friend class node; // a view of the entries of one node
+  friend class phaseBench; // times the phases of a time step (Bench.cxx)
   int num_host, num_guest;
-  vector<node> memberNodes;
+  vector<double> opinion, cost, total_utility;
+  vector<int> node_type;
+  vector<char> idling; // not vector<bool>, so threads can write
+                       //   the entries of different nodes
+  vector<agent> agents;
+  philoxRandom rng;
+  long int time_step;
+  threadPool *pool;
   struct modelParameters par;
-  vector<int> adjMatrix, num_link, distMatrix, distHistogram;
-  vector<double> utMatrix, forceMatrix;
+  struct utilityConstants utc;
+  struct edgeConstants ec;
+  vector<double> cost_table; // cost_table[k]: cost of k links
+  vector<int> num_link, distMatrix, distHistogram;
+  vector<vector<int> > adjList;    // adjList[i][k]: k-th partner of node i
+  vector<vector<int> > adjEdge;    // adjEdge[i][k]: slot of the link to adjList[i][k]
+  edgeList edges;
+  bool ut_up2date;
+  vector<double> op_ut;
+  vector<char> op_dirty;
+  vector<int> dirty_slots;
+  vector<double> ut_prefix; // ut_prefix[prefix_start[i]+k]: utilities
+  vector<int> prefix_start; //   of the links 0..k of node i
+  atomic<bool> prefix_up2date; // cleared by insertLink and eraseLink,
+                               //   which may run on several threads
+  int link_count[3];    // 0: host-host, 1: host-guest, 2: guest-guest
+  double link_rw[3];    // same order as link_count
+  eventQueue events;
+  vector<double> event_rate;
+  double event_time;
+  vector<uint32_t> event_draw;
+  vector<int> n_cuttable;
+  vector<char> saturated;
+  int n_active;
+  bool events_up2date;
   bool dist_up2date;
   struct modelStats stats;
   // For initiating connections (NodeListC.cxx)
@@ -180,33 +371,137 @@ private:
 				double rw_prob);
   void linkGuests2RandomHosts(int nLinkEach, int n_host);
   void RandomLinks(int nLinkEach);
+  void appendNode(int ntype, double ini_op, agent graph_agent);
+  int findConnection(int i, int j); // offset of j in unsorted adjList[i], or -1
   // For setting the status of nodes (NodeListC.cxx)
   void setGuestsIdling(bool value);
   // For model parameters (ModelC.cxx)
   void setDefaultParameters(void);
+  void setUtilityConstants(void);
+  void setCostTable(int max_link);
+  bool denseFits(string name, size_t n_entry, size_t entry_size);
   // For running the model simulation (ModelC.cxx)
   void createAdjMatrix(void);
   void createUtMatrix(void);
+  int findLink(int i, int j);  // offset of j in adjList[i], or -1
+  void addLink(int i, int j, double ut_ij, double ut_ji);
+  void cutLink(int i, int j);
+  void insertLink(int i, int j, double ut_ij, double ut_ji, // lists only,
+		  int e=-1);                                //  no tallies
+  double eraseLink(int i, int j);
+  void compactEdges(void);
+  // utility of node i from its link to adjList[i][k]
+  double linkUtility(int i, int k) {return edges.getUtility(adjEdge[i][k], i);}
+  int linkType(int i, int j); // index of link_count & link_rw
+  void forEachRange(int n_item, function<void(int, int)> body);
+  void forEachNodeRange(function<void(int, int)> body);
   void updateUtMatrix(void);
+  void verifyUtMatrix(void);
+  void updateUtPrefix(void);
+  int samplePartner(int i, double u); // offset in adjList[i], or -1
   void updateOpinion(void);  // See ModelC.cxx for the difference
   void updateOpinion2(void); //  between updateOpinion & updateOpinion2
   void updateOpinionGuest(void);
   void updateOpinion2Guest(void);
   void evolveAdjMatrix(void);
+  int selectCandidate(int i, int stream=RNG_EVOLVE, // $(draw): counter of
+		      uint32_t *draw=NULL);           //  the draws (NULL: 0)
+  int evolveOneLink(int i, int j, double &d_rw, int e);
+  int decideLink(int i, int j, double &ut_ij, double &ut_ji);
+  void evolveAdjMatrixSync(void); // synchronous variant (sync_net)
+  // Kernels of the utility function for each type of link
+  //   (defined below; hosts are the nodes [0, num_host))
+  inline double utilityHH(double x1, double x2);
+  inline double utilityGG(double x1, double x2);
+  inline void utilityHG(double xh, double xg, double &ut_h, double &ut_g);
+  inline void utilityPair(int i, int j, double &ut_ij, double &ut_ji);
+  inline double gaussExp(double x); // accurateExp or fastExp, by $(par.fast_exp)
+  inline double linkCost(int k);    // exp(k/alpha), tabulated
   void updateConnection(void);
+  // For the event-driven engine (EventC.cxx)
+  void runEvents(double t_span);
+  void initEvents(void);
+  void opinionEvent(int i);
+  void linkEvent(int i);
+  double opinionRate(int i);
+  double linkRate(int i);
+  bool cutAccepted(int i, double ut); // whether i cuts its link of utility ut
+  void countCuttable(int i); // also sets saturated[i]
+  void setEventRate(int id, double rate, bool fired);
   // For graphic display (GraphModelC.cxx)
-  void createForceMatrix(void);
-  void updateForceMatrix(void);
-  void updatePosition(void);
-  vector<double> forceFunction(int ntype1, double x1, vector<double> p1,
-			       int ntype2, double x2, vector<double> p2);
-  vector<double> repulsionFunction(int ntype1, double x1, vector<double> p1,
-				   int ntype2, double x2, vector<double> p2);
+  void updateForces(const vector<double> &pos, vector<double> &force);
+  void updatePosition(const vector<double> &pos, const vector<double> &force);
+  void forceFunction(int ntype1, double x1, const double *p1,
+		     int ntype2, double x2, const double *p2, double *force);
+  void repulsionFunction(int ntype1, double x1, const double *p1,
+			 int ntype2, double x2, const double *p2, double *force);
   // For statistics (StatC.cxx)
   void updateDistMatrix(void);
-  vector<int> algorithmDijkstra(int n, int src);
-  int minDistance(int m, vector<int> dist, vector<bool> spt_set);
+  int breadthFirstSearch(int src, vector<int> &dist, vector<int> &queue);
 };
 
+/******************************************************************
+  These functions return the utility that each end of a host-host
+    or a guest-guest link receives, which is the same at both ends,
+    given the opinions $(x1) and $(x2) of the two nodes.
+ ******************************************************************/
+inline double nodeList::utilityHH(double x1, double x2) {
+  double diff = x1 - x2;
+  return utc.A_same * gaussExp(-(diff*diff*utc.inv_h));
+}
+
+inline double nodeList::utilityGG(double x1, double x2) {
+  double diff = x1 - x2;
+  return utc.A_same * gaussExp(-(diff*diff*utc.inv_g));
+}
+
+/******************************************************************
+  This subroutine computes the utilities of a host-guest link.
+  Input values:
+     $(xh) and $(xg) are the opinions of the host and the guest.
+     $(ut_h) and $(ut_g) receive the utilities of the host and
+        of the guest.
+ ******************************************************************/
+inline void nodeList::utilityHG(double xh, double xg,
+				double &ut_h, double &ut_g) {
+  double diff2 = (xh - xg)*(xh - xg);
+  ut_h = utc.A_cross * gaussExp(-(diff2*utc.inv_h));
+  ut_g = utc.A_cross * gaussExp(-(diff2*utc.inv_g));
+}
+
+/******************************************************************
+  These functions return the exponential in the utility function,
+    by accurateExp or fastExp (the same as the kernels of edgeList),
+    and the cost of maintaining $(k) links,
+    from the table when it is large enough.
+ ******************************************************************/
+inline double nodeList::gaussExp(double x) {
+  return par.fast_exp ? fastExp(x) : accurateExp(x);
+}
+
+inline double nodeList::linkCost(int k) {
+  return (static_cast<size_t>(k) < cost_table.size()) ? cost_table[k]
+    : exp(k/par.alpha);
+}
+
+/******************************************************************
+  This subroutine computes the utilities of a link between nodes
+    $(i) and $(j), choosing the kernel by the blocks of indices.
+  Input values:
+     $(ut_ij) receives the utility of node i given by node j.
+     $(ut_ji) receives the utility of node j given by node i.
+ ******************************************************************/
+inline void nodeList::utilityPair(int i, int j,
+				  double &ut_ij, double &ut_ji) {
+  double xi = opinion[i], xj = opinion[j];
+  if(i < num_host) {
+    if(j < num_host) ut_ij = ut_ji = utilityHH(xi, xj);
+    else utilityHG(xi, xj, ut_ij, ut_ji);
+  } else {
+    if(j < num_host) utilityHG(xj, xi, ut_ji, ut_ij);
+    else ut_ij = ut_ji = utilityGG(xi, xj);
+  }
+}
+
 
 #endif
@@ -0,0 +1,38 @@
+/* ============================================================
+   Source codes for the philoxRandom class
+
+   Author: Yao-li Chuang
+   ============================================================ */
+#include"RandomC.hpp"
+#include<random>
+
+/*****************************************************************
+  This subroutine sets the seed (the key of the generator).
+  Input:
+     value - the seed; if it is 0, a seed is drawn from the
+             nondeterministic source of the system, so that runs
+             started at the same time still differ. 
+ *****************************************************************/
+void philoxRandom::setSeed(uint64_t value) {
+  while(value == 0) {
+    random_device source;
+    value = (static_cast<uint64_t>(source()) << 32) ^ source();
+  }
+  seed = value;
+}
+
+/*****************************************************************
+  This subroutine fills $(u) with one uniform random number per
+    node for a given time step, stream, and index of draw, for
+    the $(count) nodes from $(first):
+       u[m] = uniform(step, first+m, stream, index)
+  (The rounds of several counters interleaved in vector lanes were
+    slower than these scalar rounds, whose 32x32-bit products are
+    cheap, so the counters are run one after another.)
+ *****************************************************************/
+void philoxRandom::fillUniform(uint64_t step, uint32_t stream,
+			       uint32_t index, uint32_t first, int count,
+			       double *u) {
+  for(int m=0; m<count; m++)
+    u[m] = uniform(step, first+m, stream, index);
+}
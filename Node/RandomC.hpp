@@ -0,0 +1,93 @@
+/* ============================================================
+   Header file for the philoxRandom class
+   -----
+   Brief Summary: A counter-based random number generator
+                  (Philox4x32-10, Salmon et al., SC'11).
+                  Each draw is a function of a key (the seed) and
+                  a counter, here made of the time step, the node,
+                  the stream (what the number is used for), and
+                  the index of the draw. 
+   -----
+      variables --
+          seed : the seed, used as the 64-bit key
+   -----
+      There is no internal state other than the seed, so draws for
+        different nodes or time steps can be made in any order, or
+        in parallel, and still reproduce the same numbers.
+   -----
+       Functions and subroutines not defined explicitly here are
+          defined in RandomC.cxx.
+
+   Author: Yao-li Chuang
+   ============================================================ */
+#ifndef __RandomC_hpp_INCLUDED__
+#define __RandomC_hpp_INCLUDED__
+
+#include"../CCommon.h"
+#include<stdint.h>
+
+class philoxRandom {
+
+public:
+  // Constructor (seed=0: a nondeterministic seed is drawn)
+  philoxRandom(uint64_t value=0) { setSeed(value); }
+  // Getters & setters
+  uint64_t getSeed(void) {return seed;}
+  void setSeed(uint64_t value);
+  // The 4 random 32-bit words of one counter
+  inline void generate(uint64_t step, uint32_t node, uint32_t stream,
+		       uint32_t index, uint32_t out[4]);
+  // A uniform random number in [0, 1) for one counter
+  inline double uniform(uint64_t step, uint32_t node, uint32_t stream,
+			uint32_t index);
+  // Uniform random numbers of the nodes $(first) to first+count-1
+  //   for one time step: u[m] = uniform(step, first+m, stream, index)
+  void fillUniform(uint64_t step, uint32_t stream, uint32_t index,
+		   uint32_t first, int count, double *u);
+
+private:
+  uint64_t seed;
+};
+
+/*****************************************************************
+  This subroutine computes the 10 rounds of Philox4x32 for the
+    counter (index, node, step low 32 bits, stream and step
+    high 24 bits).
+ *****************************************************************/
+inline void philoxRandom::generate(uint64_t step, uint32_t node,
+				   uint32_t stream, uint32_t index,
+				   uint32_t out[4]) {
+  uint32_t c0 = index, c1 = node;
+  uint32_t c2 = static_cast<uint32_t>(step);
+  uint32_t c3 = (stream << 24) ^ static_cast<uint32_t>(step >> 32);
+  uint32_t k0 = static_cast<uint32_t>(seed);
+  uint32_t k1 = static_cast<uint32_t>(seed >> 32);
+  for(int r=0; r<10; r++) {
+    uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * c0;
+    uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * c2;
+    uint32_t hi0 = static_cast<uint32_t>(p0 >> 32), lo0 = static_cast<uint32_t>(p0);
+    uint32_t hi1 = static_cast<uint32_t>(p1 >> 32), lo1 = static_cast<uint32_t>(p1);
+    c0 = hi1 ^ c1 ^ k0;
+    c1 = lo1;
+    c2 = hi0 ^ c3 ^ k1;
+    c3 = lo0;
+    k0 += 0x9E3779B9u; // bump the key (Weyl sequence)
+    k1 += 0xBB67AE85u;
+  }
+  out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+}
+
+/*****************************************************************
+  This function returns a uniform random number 0 <= u < 1 with
+    53 random bits, taken from the first 2 words of the counter.
+ *****************************************************************/
+inline double philoxRandom::uniform(uint64_t step, uint32_t node,
+				    uint32_t stream, uint32_t index) {
+  uint32_t w[4];
+  generate(step, node, stream, index, w);
+  uint64_t bits = (static_cast<uint64_t>(w[0]) << 32) | w[1];
+  return static_cast<double>(bits >> 11) * (1.0/9007199254740992.0); // 2^-53
+}
+
+
+#endif
@@ -0,0 +1,143 @@
+/* ============================================================
+   Source codes for the threadPool class
+
+   Author: Yao-li Chuang
+   ============================================================ */
+#include"ThreadPoolC.hpp"
+
+// Index of the worker running on the current thread (-1: not a worker)
+static thread_local int worker_index = -1;
+static thread_local threadPool *worker_pool = NULL;
+
+/************************************************************************
+  Constructor of a thread pool
+  Input:
+     n_threads - number of worker threads (0: one per hardware thread)
+*************************************************************************/
+threadPool::threadPool(int n_threads) : pending(0), next_queue(0),
+					 stopping(false) {
+  if(n_threads <= 0)
+    n_threads = thread::hardware_concurrency();
+  if(n_threads <= 0) n_threads = 1;
+  for(int i=0; i<n_threads; i++)
+    queues.push_back(new taskQueue);
+  for(int i=0; i<n_threads; i++)
+    workers.push_back(thread(&threadPool::workerLoop, this, i));
+}
+
+/************************************************************************
+  Destructor: the workers finish the remaining tasks and stop.
+*************************************************************************/
+threadPool::~threadPool(void) {
+  {
+    lock_guard<mutex> guard(sleep_lock);
+    stopping = true;
+  }
+  sleep_cv.notify_all();
+  for(size_t i=0; i<workers.size(); i++)
+    workers[i].join();
+  for(size_t i=0; i<queues.size(); i++)
+    delete queues[i];
+}
+
+/************************************************************************
+  This subroutine submits a task to the pool.
+  Input:
+     task - the function to run
+     group - the group the task belongs to (see wait)
+*************************************************************************/
+void threadPool::submit(function<void(void)> task, taskGroup &group) {
+  int q;
+  if(worker_pool == this)
+    q = worker_index;   // keep the task on the current worker
+  else
+    q = next_queue++ % queues.size();
+  group.pending++;
+  pending++;
+  {
+    lock_guard<mutex> guard(queues[q]->lock);
+    queues[q]->tasks.push_back(make_pair(task, &group));
+  }
+  {
+    lock_guard<mutex> guard(sleep_lock); // so that no worker misses the notice
+  }
+  sleep_cv.notify_one();
+}
+
+/************************************************************************
+  This function runs one task, taken from the back of queue $(id)
+    or, if that is empty, stolen from the front of another queue.
+  Input:
+     id - index of the queue of the calling worker (-1: not a worker)
+  Return value:
+     true if a task was run, false if no task was found
+*************************************************************************/
+bool threadPool::runOneTask(int id) {
+  pair<function<void(void)>, taskGroup*> job;
+  bool found = false;
+  int nq = queues.size();
+  if(id >= 0) {
+    lock_guard<mutex> guard(queues[id]->lock);
+    if(!queues[id]->tasks.empty()) {
+      job = queues[id]->tasks.back();
+      queues[id]->tasks.pop_back();
+      found = true;
+    }
+  }
+  for(int k=1; !found && k<=nq; k++) { // try to steal from the others
+    int v = (id+k+nq)%nq;
+    if(v == id) continue;
+    lock_guard<mutex> guard(queues[v]->lock);
+    if(!queues[v]->tasks.empty()) {
+      job = queues[v]->tasks.front();
+      queues[v]->tasks.pop_front();
+      found = true;
+    }
+  }
+  if(!found) return false;
+
+  job.first();
+  // The group may be gone once its count reaches 0 (its waiter
+  //   returns), so it is not touched after the decrement.
+  long left = --job.second->pending;
+  if(--pending == 0 || left == 0) {
+    lock_guard<mutex> guard(sleep_lock);
+    sleep_cv.notify_all(); // wake up the threads waiting for the group
+  }
+  return true;
+}
+
+/************************************************************************
+  This subroutine is the main loop of a worker thread.
+  Input:
+     id - index of the worker
+*************************************************************************/
+void threadPool::workerLoop(int id) {
+  worker_index = id;
+  worker_pool = this;
+  for(;;) {
+    if(runOneTask(id)) continue;
+    unique_lock<mutex> guard(sleep_lock);
+    if(stopping && pending == 0) break;
+    if(pending == 0)
+      sleep_cv.wait(guard);
+    else  // tasks are being run elsewhere; check again shortly
+      sleep_cv.wait_for(guard, chrono::milliseconds(1));
+  }
+}
+
+/************************************************************************
+  This subroutine waits until all tasks of a group are done.
+  The calling thread runs pending tasks in the meantime.
+  Input:
+     group - the group of tasks to wait for
+*************************************************************************/
+void threadPool::wait(taskGroup &group) {
+  int id = (worker_pool == this) ? worker_index : -1;
+  while(group.pending > 0) {
+    if(runOneTask(id)) continue;
+    unique_lock<mutex> guard(sleep_lock);
+    if(group.pending > 0)
+      sleep_cv.wait_for(guard, chrono::milliseconds(1));
+  }
+}
@@ -0,0 +1,79 @@
+/* ============================================================
+   Header file for the threadPool class
+   -----
+   Brief Summary: A pool of worker threads running independent
+                  tasks (e.g., the simulations of a parameter
+                  sweep) with work stealing.
+   -----
+      variables --
+          workers : the worker threads
+          queues : one task queue per worker; tasks submitted
+                   from a worker go to its own queue, the others
+                   are distributed among the queues in turn
+          pending : number of tasks submitted but not yet done
+   -----
+      Each worker runs the tasks of its own queue, newest first,
+        and steals the oldest task of another queue when its own
+        queue is empty.
+      Tasks are grouped with a taskGroup, so that one can wait for
+        a particular group of tasks to finish. A thread waiting for
+        a group helps to run the pending tasks in the meantime.
+   -----
+       Functions and subroutines not defined explicitly here are
+          defined in ThreadPoolC.cxx.
+
+   Author: Yao-li Chuang
+   ============================================================ */
+#ifndef __ThreadPoolC_hpp_INCLUDED__
+#define __ThreadPoolC_hpp_INCLUDED__
+
+#include"../CCommon.h"
+#include<deque>
+#include<thread>
+#include<mutex>
+#include<condition_variable>
+#include<atomic>
+#include<functional>
+
+/**************************************************************
+  A group of tasks, counting those not yet done.
+ **************************************************************/
+struct taskGroup {
+  atomic<long> pending;
+  taskGroup(void) : pending(0) {}
+};
+
+/**************************************************************
+   threadPool class
+ **************************************************************/
+class threadPool {
+
+public:
+  // Constructor & destructor
+  // n_threads=0 uses as many threads as the hardware supports.
+  threadPool(int n_threads=0);
+  ~threadPool(void);
+  // Getters
+  int getNumThreads(void) {return workers.size();}
+  // Running tasks
+  void submit(function<void(void)> task, taskGroup &group);
+  void wait(taskGroup &group); // wait until all tasks in $(group) are done
+
+private:
+  struct taskQueue {
+    mutex lock;
+    deque<pair<function<void(void)>, taskGroup*> > tasks;
+  };
+  vector<thread> workers;
+  vector<taskQueue*> queues;
+  atomic<long> pending;
+  atomic<unsigned int> next_queue;
+  bool stopping;
+  mutex sleep_lock;
+  condition_variable sleep_cv;
+  void workerLoop(int id);
+  bool runOneTask(int id); // run one task of queue $(id) or stolen elsewhere
+};
+
+
+#endif
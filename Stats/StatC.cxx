@@ -3,9 +3,12 @@
    This file contains subroutines and functions related to
      the calculation of statistics data.
 	    void computeStats
+	    void writeStatsHeader
+	    void writeStats
+	    vector<string> getStatsNames
+	    void getStatsValues
 	    void updateDistMatrix
-	    vector<int> algorithmDijkstra
-	    int minDistance
+	    int breadthFirstSearch
 	    int numCluster
 	    vector<int> degreeConnectionSnapshot
 
@@ -18,19 +21,21 @@
       the average utility $(stats.avg_ut) per node. 
       (Here the utility includes the cost of maintaining the social 
        connections.)
+   The indicators derived from these and from the link statistics
+      (updated in updateConnection) are computed as well.
    No input and return values.
  ***********************************************************************/
 void nodeList::computeStats(void) {
-  int n=memberNodes.size();
+  int n=opinion.size();
   double op_tot=0., op_h=0., op_g=0.;
   double ut_tot=0., ut_h=0., ut_g=0.;
   for(int i=0; i<n; i++) {
-    if(memberNodes.at(i).getNodeType()==1) {
-      op_h += memberNodes.at(i).getOpinion();
-      ut_h += memberNodes.at(i).getUtCost();
-    } else if(memberNodes.at(i).getNodeType()==-1) {
-      op_g += memberNodes.at(i).getOpinion();
-      ut_g += memberNodes.at(i).getUtCost();
+    if(node_type[i]==1) {
+      op_h += opinion[i];
+      ut_h += total_utility[i] - cost[i];
+    } else if(node_type[i]==-1) {
+      op_g += opinion[i];
+      ut_g += total_utility[i] - cost[i];
     }
   }
   op_tot = op_h + op_g;
@@ -46,57 +51,129 @@ void nodeList::computeStats(void) {
   ut_tot /= static_cast<double>(num_host+num_guest);
   double tmp_ut[] = {ut_tot, ut_h, ut_g};
   stats.avg_ut.assign(tmp_ut, tmp_ut+3);
+
+  // Derived indicators
+  double guest_ratio = static_cast<double>(num_guest)
+                      /static_cast<double>(num_host+num_guest);
+  vector<double> &alink = stats.avg_link, &arw = stats.avg_rw;
+  stats.integration = (alink.at(3)/(alink.at(3)+alink.at(4)))/(1-guest_ratio);
+  stats.ut_ratio = ut_g/ut_h;
+  double cross_ratio = 2.0*guest_ratio*(1.0-guest_ratio);
+  stats.rw_cross = (arw.at(3)/arw.at(0))/cross_ratio;
 }
 
 /************************************************************************
-   This subroutine updates the distance matrix $(distMatrix) and the
-     histogram of the distance distribution $(distHistogram).
-   The distance between each pair of nodes is calculated using
-     Dijkstra's algorithm. 
-   No input and return values.
+   This subroutine writes the names of the columns written by writeStats,
+      separated by tabs.
+   Input value:
+      $(out) is the stream to write to.
  ***********************************************************************/
-void nodeList::updateDistMatrix(void) {
+void nodeList::writeStatsHeader(ostream &out) {
+  out << "link_all\tlink_h2h/h\tlink_h2g/h\tlink_g2h/g\tlink_g2g/g"
+      << "\tintegration"
+      << "\tut_all\tut_host\tut_guest"
+      << "\top_all\top_host\top_guest"
+      << "\tut_ratio\trw_cross";
+}
 
-  // Here we check if adjMatrix is filled or empty. 
-  // If it is already filled, we will use it directly.
-  // If it is empty, we will create it for this subroutine but then
-  //    clear it before we exit this subroutine.
-  bool adj_empty=adjMatrix.empty();
-  if(adj_empty)
-    createAdjMatrix();
+/************************************************************************
+   This subroutine writes the current statistics as one row of
+      tab-separated columns (without the end of the line).
+   computeStats should be called first.
+   Input value:
+      $(out) is the stream to write to.
+ ***********************************************************************/
+void nodeList::writeStats(ostream &out) {
+  for(int i=0; i<5; i++)
+    out << (i>0 ? "\t" : "") << stats.avg_link.at(i);
+  out << '\t' << stats.integration;
+  for(int i=0; i<3; i++)
+    out << '\t' << stats.avg_ut.at(i);
+  for(int i=0; i<3; i++)
+    out << '\t' << stats.avg_op.at(i);
+  out << '\t' << stats.ut_ratio << '\t' << stats.rw_cross;
+}
 
+/************************************************************************
+   These return the names and the values of all fields of the
+      statistics, in the same order, for the records of a statsWriter
+      (see StatsWriterC.hpp).
+   computeStats should be called before getStatsValues.
+   Input value:
+      $(values) receives the values, appended to its end.
+ ***********************************************************************/
+vector<string> nodeList::getStatsNames(void) {
+  const char *names[] = {
+    "link_all", "link_h2h/h", "link_h2g/h", "link_g2h/g", "link_g2g/g",
+    "op_all", "op_host", "op_guest",
+    "ut_all", "ut_host", "ut_guest",
+    "rw_all", "rw_hh", "rw_gg", "rw_hg",
+    "integration", "ut_ratio", "rw_cross" };
+  return vector<string>(names, names+18);
+}
+
+void nodeList::getStatsValues(vector<double> &values) {
+  values.insert(values.end(), stats.avg_link.begin(), stats.avg_link.end());
+  values.insert(values.end(), stats.avg_op.begin(), stats.avg_op.end());
+  values.insert(values.end(), stats.avg_ut.begin(), stats.avg_ut.end());
+  values.insert(values.end(), stats.avg_rw.begin(), stats.avg_rw.end());
+  values.push_back(stats.integration);
+  values.push_back(stats.ut_ratio);
+  values.push_back(stats.rw_cross);
+}
+
+/************************************************************************
+   This subroutine updates the histogram of the distance distribution
+     $(distHistogram) and the distance matrix $(distMatrix).
+   The distances from each node are calculated by a breadth-first
+     search, which needs memory only in proportion to n.
+   The n x n matrix is kept only if it fits in the memory budget
+     $(par.dense_mb) (see denseFits in ModelC.cxx); otherwise it is
+     left empty and only the histogram is computed.
+   No input and return values.
+ ***********************************************************************/
+void nodeList::updateDistMatrix(void) {
   int n = num_host + num_guest;
-  distMatrix.assign(n*n, INT_MAX);
+  bool keep_matrix = denseFits("distance matrix",
+			       static_cast<size_t>(n)*n, sizeof(int));
+  distMatrix.clear();
+  if(keep_matrix)
+    distMatrix.assign(static_cast<size_t>(n)*n, INT_MAX);
   distHistogram.clear(); distHistogram.assign(50,0);
+  vector<int> dist, queue;
   for(int src=0; src<n; src++) {
-    vector<int> dist = algorithmDijkstra(n, src); // Dijkstra's algorithm
+    dist.assign(n, INT_MAX);
+    breadthFirstSearch(src, dist, queue);
     for(int v=0; v<n; v++) {
-      int dist_value = dist.at(v);
-      distMatrix.at(src*n+v) = dist_value;
+      int dist_value = dist[v];
+      if(keep_matrix)
+	distMatrix[static_cast<size_t>(src)*n+v] = dist_value;
       if(dist_value<50)
 	distHistogram.at(dist_value)++;
     }
   }
   dist_up2date=true;
-
-  if(adj_empty) // if adjMatrix is originally empty, clear it.
-    adjMatrix.clear();
 }
 
 /*********************************************************************
   This function computes the shortest distances from one node to
-     all the other nodes using Dijkstra's algorithm.
+     the other nodes by a breadth-first search of adjList.
    Input values: 
-       $(n) is the number of nodes.
        $(src) is the index of the node from which the distances to
-              all the other nodes are calculated.
-   The return value is an integer vector of length $(n), representing
-       the distances from $(src) to all the nodes.
+              the other nodes are calculated.
+       $(dist) holds the distances of the nodes. Only the nodes with
+              a distance of $(INT_MAX) are visited, so the caller
+              sets it to $(INT_MAX) for the nodes to search.
+       $(queue) is a work array (its contents are discarded).
+   The return value is the number of nodes reached from $(src),
+       including $(src) itself.
   -----
    The distance between two nodes means the number of edges to traverse
-       from one node to the other. Usually it implies the shortest path,
-       i.e., the path through the fewest edges (assuming that the edges
-       are not weighted). 
+       from one node to the other, i.e., the path through the fewest
+       edges (the edges are not weighted). Since all edges count the
+       same, the search visits the nodes in the order of their
+       distances, which gives the same distances as Dijkstra's
+       algorithm in O(n + number of links).
   -----
    If there exists no path from one node to the other, then the distance
        is infinity, which is assigned the value of maximal integer
@@ -104,102 +181,45 @@ void nodeList::updateDistMatrix(void) {
   -----
    The distance from a node to itself is zero.
  *********************************************************************/
-vector<int> nodeList::algorithmDijkstra(int n, int src) {
-  vector<int> dist(n, INT_MAX);   // set all distances to infinity
-  vector<bool> spt_set(n, false); // mark all nodes unvisited
-  dist.at(src) = 0;               // set distance=0 to itself
-  int cnt_total = n - 1;
-  for(int cnt = 0; cnt<cnt_total; cnt++) {
-    // Look for the node with the shortest distance among univisted nodes.
-    int u = minDistance(n, dist, spt_set);
-    if(u == -1)
-      cout << "minDistance not found in Dijkstra" << endl;
-    else
-      spt_set.at(u) = true;  // mark the node visited.
-    
-    // Update the tentative distances of the other unvisited nodes.
-    // Given the shortest distance to node $(u) we just found, the
-    //    distance to an unvisited node with a direct link to $(u) 
-    //    would tentatively be this shortest distance + 1, unless
-    //    it is already shorter (through another visited node). 
-    // The other tentative distances remain unchanged.
-    for(int v=0; v<n; v++) {
-      int new_dist = dist.at(u)+adjMatrix.at(u*n+v);
-      if(!spt_set.at(v) && adjMatrix.at(u*n+v)!=0 && dist.at(u)!=INT_MAX
-	 && new_dist<dist.at(v))
-	dist.at(v) = new_dist;
-    } // end of v loop for updating dist vector
-  } // end of cnt loop for going through the nodes;
-
-  return dist;
-}
-
-/*********************************************************************
-  This function is a part of Dijkstra's algorithm.
-  It searches for a node among unvisited nodes of which 
-      the distance (to $(src) in the function above) is
-      the shortest.
-   Input values: 
-       $(m) is the number of nodes.
-       $(dist) is a list of distances already calculated for these nodes.
-       $(spt_set) is a list of flags indicating whether each node is
-                  already visited or still unvisited.
-   The return value is an integer index of the node found. 
-   If such a node is not found, it returns -1, indicating there may be
-      an error somewhere.
- *********************************************************************/
-int nodeList::minDistance(int m, vector<int> dist, vector<bool> spt_set) {
-  int min_dist = INT_MAX, min_index = -1;
-
-  for(int v=0; v<m; v++)
-    if(spt_set.at(v)==false && dist.at(v) <= min_dist) {
-      min_dist = dist.at(v);
-      min_index = v;
-    }
-
-  return min_index;
+int nodeList::breadthFirstSearch(int src, vector<int> &dist,
+				 vector<int> &queue) {
+  queue.clear();
+  dist[src] = 0;
+  queue.push_back(src);
+  for(size_t head=0; head<queue.size(); head++) {
+    int u = queue[head];
+    int nlinku = adjList[u].size();
+    for(int k=0; k<nlinku; k++) {  // looping through the partners of u
+      int v = adjList[u][k];
+      if(dist[v] == INT_MAX) { // not visited yet
+	dist[v] = dist[u]+1;
+	queue.push_back(v);
+      }
+    } // end of k loop
+  } // end of head loop
+  return queue.size();
 }
 
 /**************************************************************
    This function returns the number of clusters at the moment.
    Return value ----
        An integer, representing the number of clusters
+  -----
+   Every search from a node not yet reached marks one cluster,
+     i.e., the nodes directly or indirectly connected to it,
+     so the clusters are counted in O(n + number of links)
+     without the distance matrix.
  **************************************************************/
 int nodeList::numCluster(void) {
-  // Need the updated distance matrix to count the number of clusters
-  if(!IsDistMatrixUpdated())
-    updateDistMatrix();
-
   int n=num_host+num_guest;
-  vector<int> idx;
+  vector<int> dist(n, INT_MAX), queue;
+  int n_cluster = 0;
   for(int i=0; i<n; i++)
-    idx.push_back(i);    // putting all nodes in vector $(idx)
-  vector<vector<int> > clusters;
-  // The loop below goes through the vector $(idx) to look for nodes
-  //    belonging to the same cluster.
-  // If nodes are found to be in the same cluster as the first node in
-  //    $(idx), these nodes and the first node are put in vector $(group).
-  // Those not in the same group are left in $(idx) for the next loop.
-  for(;!idx.empty();) { 
-    vector<int> tmpid(idx), group;
-    group.clear(); idx.clear();
-    int m=tmpid.size(), src=tmpid.at(0); group.push_back(src);
-    // The loop below checks the distance between two nodes: 
-    //    tmpid.at(0) (i.e., src) and tmpid.at(i), which 
-    //    is already calculated and stored in distMatrix.
-    // If the distance is finite, the two nodes are directly
-    //    or indirectly connected, thus belonging to the same cluster.
-    // If the distance is infinite (INT_MAX), the two nodes 
-    //    belongs to different clusters.
-    for(int i=1; i<m; i++)
-      if(distMatrix.at(src*n+tmpid.at(i))<INT_MAX)
-	group.push_back(tmpid.at(i)); // putting those in the same cluster in $(group)
-      else
-	idx.push_back(tmpid.at(i)); // putting those not in the same cluster back in $(idx)
-
-    clusters.push_back(group); // collecting the groups in vector $(clusters)
-  }
-  return clusters.size(); // the length of vector $(clusters) is the number of distinct clusters
+    if(dist[i] == INT_MAX) { // node i is not in the clusters found so far
+      breadthFirstSearch(i, dist, queue);
+      n_cluster++;
+    }
+  return n_cluster;
 }
 
 /**************************************************************
@@ -214,7 +234,7 @@ vector<int> nodeList::degreeConnectionSnapshot(int n_degree) {
   vector<int> degree(n_degree,0);
   int n= num_host+num_guest;
   for(int i=0; i<n; i++) {
-    int u=memberNodes.at(i).getNumConnections();
+    int u=num_link[i];
     if(u<n_degree)
       degree.at(u)++;
   }
@@ -0,0 +1,299 @@
+/* ============================================================
+   Source codes for the statsWriter class
+            the constructor and the destructor
+            void setCadence
+            bool isDue
+            void truncateAfter
+            void append
+            void flush
+            bool sync
+            void writerLoop
+            void writeRecords
+
+   Author: Yao-li Chuang
+   ============================================================ */
+#include"StatsWriterC.hpp"
+#include<stdint.h>
+#include<unistd.h>
+#include<cstring>
+#include<chrono>
+
+// Number of values in a buffer handed to the background thread
+static const size_t buffer_values = 1 << 16;
+
+/************************************************************************
+  The binary files are little-endian on any processor: these helpers
+    tell whether the processor is little-endian, and reverse the
+    bytes of each of the $(n_item) items of $(item_size) bytes in
+    $(data) (from and to little-endian on a big-endian processor).
+*************************************************************************/
+static bool littleEndianHost(void) {
+  uint16_t one = 1;
+  unsigned char low;
+  memcpy(&low, &one, 1);
+  return low == 1;
+}
+
+static void swapBytes(void *data, size_t item_size, size_t n_item) {
+  unsigned char *p = static_cast<unsigned char *>(data);
+  for(size_t k=0; k<n_item; k++, p+=item_size)
+    reverse(p, p+item_size);
+}
+
+/************************************************************************
+  Constructor of a stats writer, which opens the file and writes
+    the header.
+  Inputs:
+     file_name - name of the output file
+     columns - names of the columns
+     is_binary - whether the file is binary (otherwise CSV)
+     append_to - whether the records are appended to the file if it
+                 is not empty (e.g., by a run continued from a
+                 checkpoint), with no new header (default false)
+*************************************************************************/
+statsWriter::statsWriter(string file_name, const vector<string> &columns,
+			 bool is_binary, bool append_to)
+  : binary(is_binary), n_column(columns.size()), every(1), decimate(0),
+    stopping(false), busy(false) {
+  bool appending = false;
+  if(append_to) {
+    ifstream old(file_name.data(), ios::in | ios::binary | ios::ate);
+    appending = old.is_open() && old.tellg() > 0;
+  }
+  out = fopen(file_name.data(), appending ? "ab" : "wb");
+  if(out == NULL) {
+    cout << "Error in statsWriter: unable to open " << file_name << endl;
+    exit(1);
+  }
+  if(appending) {
+    // no header; the file already has one
+  } else if(binary) {
+    string names;
+    for(int c=0; c<n_column; c++)
+      names += columns[c] + '\n';
+    uint32_t head[2];
+    head[0] = n_column;
+    head[1] = (16 + names.size() + 7)/8*8;
+    names.resize(head[1]-16, '\0');
+    if(!littleEndianHost()) swapBytes(head, sizeof(uint32_t), 2);
+    fwrite("ADSTATS1", 1, 8, out);
+    fwrite(head, sizeof(head), 1, out);
+    fwrite(names.data(), 1, names.size(), out);
+  } else {
+    string names;
+    for(int c=0; c<n_column; c++)
+      names += (c>0 ? "," : "") + columns[c];
+    names += '\n';
+    fwrite(names.data(), 1, names.size(), out);
+  }
+  filling.reserve(buffer_values);
+  writer = thread(&statsWriter::writerLoop, this);
+}
+
+/************************************************************************
+  Destructor: the records appended are all written before the file
+    is closed.
+*************************************************************************/
+statsWriter::~statsWriter(void) {
+  flush();
+  {
+    lock_guard<mutex> guard(lock);
+    stopping = true;
+  }
+  wake.notify_one();
+  writer.join();
+  fclose(out);
+}
+
+/************************************************************************
+  This subroutine sets the cadence of the records (see isDue).
+  Inputs:
+     n_every - time steps between records
+     n_decimate - number of records after which the time between
+                  records is doubled (default 0: never)
+*************************************************************************/
+void statsWriter::setCadence(long int n_every, long int n_decimate) {
+  every = (n_every > 0) ? n_every : 1;
+  decimate = (n_decimate > 0) ? n_decimate : 0;
+}
+
+/************************************************************************
+  This function returns whether a record is due at the time step
+    $(t) with the cadence $(n_every) and the decimation $(n_decimate),
+    i.e., t is a multiple of n_every from 0. With decimation, the
+    records are taken every n_every steps n_decimate times, then every
+    2*n_every steps n_decimate times, and so on, so a long run has
+    about n_decimate*log2(n_steps/(n_decimate*n_every)) records.
+*************************************************************************/
+bool statsWriter::isDue(long int t, long int n_every, long int n_decimate) {
+  if(t < 0) return false;
+  long int start = 0, step = (n_every > 0) ? n_every : 1;
+  if(n_decimate > 0)
+    while(t > start + n_decimate*step) {
+      start += n_decimate*step;
+      step *= 2;
+    } // end of while loop
+  return (t - start)%step == 0;
+}
+
+/************************************************************************
+  This subroutine cuts the records whose first value (the time) is
+    greater than $(t_last) from the end of a file written by a stats
+    writer, and a record left incomplete, e.g., by a run that was
+    killed, so that a run continued from a checkpoint at $(t_last)
+    appends its records with no gap and no duplicate.
+  Inputs:
+     file_name - name of the file (nothing is done if it is empty or
+                 does not exist)
+     is_binary - whether the file is binary (otherwise CSV)
+     n_column - number of values per record
+     t_last - time of the last record kept
+*************************************************************************/
+void statsWriter::truncateAfter(string file_name, bool is_binary,
+				int n_column, double t_last) {
+  ifstream in(file_name.data(), ios::in | ios::binary);
+  if(!in.is_open()) return;
+  long int keep = 0; // bytes kept
+  if(is_binary) {
+    char magic[8];
+    uint32_t head[2];
+    in.read(magic, 8);
+    in.read(reinterpret_cast<char *>(head), sizeof(head));
+    if(!littleEndianHost()) swapBytes(head, sizeof(uint32_t), 2);
+    if(!in) {
+      keep = 0; // an incomplete header; the header is written anew
+    } else if(string(magic, 8).compare("ADSTATS1") != 0
+	      || static_cast<int>(head[0]) != n_column) {
+      cout << "Error in statsWriter::truncateAfter: " << file_name
+	   << " is not a stats file of " << n_column << " columns" << endl;
+      exit(1);
+    } else {
+      keep = head[1];
+      in.seekg(keep);
+      vector<double> rec(n_column);
+      while(in.read(reinterpret_cast<char *>(rec.data()),
+		    n_column*sizeof(double))) {
+	if(!littleEndianHost()) swapBytes(rec.data(), sizeof(double), 1);
+	if(rec[0] > t_last) break;
+	keep += n_column*sizeof(double);
+      } // end of while loop
+    }
+  } else {
+    string line;
+    if(getline(in, line) && !in.eof()) { // the line of the names
+      keep = in.tellg();
+      while(getline(in, line) && !in.eof()
+	    && strtod(line.c_str(), NULL) <= t_last)
+	keep = in.tellg();
+    }
+  } // end of if-else (binary) statement
+  in.close();
+  if(truncate(file_name.data(), keep) != 0) {
+    cout << "Error in statsWriter::truncateAfter: unable to cut "
+	 << file_name << endl;
+    exit(1);
+  }
+}
+
+/************************************************************************
+  This subroutine appends one record of $(n_column) values.
+  It can be called from several threads; the buffer is handed to the
+    background thread when it is full.
+*************************************************************************/
+void statsWriter::append(const double *values) {
+  lock_guard<mutex> guard(lock);
+  filling.insert(filling.end(), values, values+n_column);
+  if(filling.size() + n_column > buffer_values) {
+    full.push_back(vector<double>());
+    full.back().swap(filling);
+    filling.reserve(buffer_values);
+    wake.notify_one();
+  }
+}
+
+/************************************************************************
+  This subroutine hands the records appended so far to the background
+    thread, which writes them to the file soon.
+*************************************************************************/
+void statsWriter::flush(void) {
+  lock_guard<mutex> guard(lock);
+  if(filling.empty()) return;
+  full.push_back(vector<double>());
+  full.back().swap(filling);
+  filling.reserve(buffer_values);
+  wake.notify_one();
+}
+
+/************************************************************************
+  This function waits until the records appended so far are written,
+    and flushes the file to the disk (e.g., before a checkpoint, so
+    the file holds all records up to it).
+  Return value:
+     false if the file could not be flushed to the disk.
+*************************************************************************/
+bool statsWriter::sync(void) {
+  flush();
+  unique_lock<mutex> guard(lock);
+  drained.wait(guard, [this]() { return full.empty() && !busy; });
+  if(fflush(out) != 0 || fsync(fileno(out)) != 0) {
+    cout << "Error in statsWriter::sync: unable to write the records" << endl;
+    return false;
+  }
+  return true;
+}
+
+/************************************************************************
+  The loop of the background thread, which writes the full buffers
+    in order until the writer is stopping and nothing is left.
+  When no buffer has been handed over for a second, the records in
+    the buffer being filled are taken and written.
+*************************************************************************/
+void statsWriter::writerLoop(void) {
+  for(;;) {
+    vector<double> buf;
+    {
+      unique_lock<mutex> guard(lock);
+      if(!wake.wait_for(guard, chrono::seconds(1),
+			[this]() { return stopping || !full.empty(); })) {
+	if(filling.empty()) continue; // timed out with nothing to write
+	buf.swap(filling);
+	filling.reserve(buffer_values);
+      } else if(full.empty()) {
+	return; // stopping
+      } else {
+	buf.swap(full.front());
+	full.pop_front();
+      }
+      busy = true;
+    }
+    writeRecords(buf);
+    {
+      lock_guard<mutex> guard(lock);
+      busy = false;
+    }
+    drained.notify_all();
+  } // end of for loop
+}
+
+/************************************************************************
+  This subroutine writes the records of one buffer to the file.
+*************************************************************************/
+void statsWriter::writeRecords(const vector<double> &buf) {
+  if(binary && littleEndianHost()) {
+    fwrite(buf.data(), sizeof(double), buf.size(), out);
+  } else if(binary) { // to little-endian
+    vector<double> le(buf);
+    swapBytes(le.data(), sizeof(double), le.size());
+    fwrite(le.data(), sizeof(double), le.size(), out);
+  } else {
+    string text;
+    char number[32];
+    for(size_t v=0; v<buf.size(); v++) {
+      snprintf(number, sizeof(number), "%.17g", buf[v]);
+      text += number;
+      text += ((v+1)%n_column == 0) ? '\n' : ',';
+    } // end of v loop
+    fwrite(text.data(), 1, text.size(), out);
+  }
+  fflush(out);
+}
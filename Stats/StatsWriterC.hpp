@@ -0,0 +1,94 @@
+/* ============================================================
+   Header file for the statsWriter class
+   -----
+   Brief Summary: A sink of time series of statistics, which
+                  appends fixed-width records of real numbers to
+                  a binary or a CSV file through a buffer written
+                  by a background thread.
+   -----
+      variables --
+          out : the output file
+          binary : whether the file is binary (otherwise CSV)
+          n_column : number of values per record
+          every : time steps between records (the cadence)
+          decimate : number of records after which $(every) is
+                     doubled (0: never, see isDue)
+          filling : buffer of the records appended
+          full : buffers handed to the background thread
+          busy : whether the background thread is writing a buffer
+          writer : the background thread writing $(full)
+   -----
+      Records are appended by any number of threads, and written in
+        the order they are appended. The background thread writes
+        the buffer when it is full, or at least once a second, so a
+        killed run loses at most the records of the last second;
+        sync waits until all records appended are on the disk.
+      Format of the binary file (all numbers little-endian):
+          "ADSTATS1" (8 bytes)
+          n_column (uint32), header_bytes (uint32, the size of this
+             header, a multiple of 8)
+          names of the columns, each ended by '\n', padded with 0
+             up to header_bytes
+          records of n_column doubles each
+        e.g., numpy.fromfile(name, dtype='<f8', offset=header_bytes)
+              .reshape(-1, n_column)
+      The CSV file has a line of the names of the columns, and then
+        one line per record, with the numbers in full precision.
+   -----
+       Functions and subroutines not defined explicitly here are
+          defined in StatsWriterC.cxx.
+
+   Author: Yao-li Chuang
+   ============================================================ */
+#ifndef __StatsWriterC_hpp_INCLUDED__
+#define __StatsWriterC_hpp_INCLUDED__
+
+#include"../CCommon.h"
+#include<cstdio>
+#include<deque>
+#include<thread>
+#include<mutex>
+#include<condition_variable>
+
+/**************************************************************
+   statsWriter class
+ **************************************************************/
+class statsWriter {
+
+public:
+  // Constructor & destructor
+  statsWriter(string file_name, const vector<string> &columns,
+	      bool is_binary, bool append_to=false);
+  ~statsWriter(void); // writes the remaining records and closes the file
+  // Getters & setters
+  int getNumColumns(void) {return n_column;}
+  bool isBinary(void) {return binary;}
+  void setCadence(long int n_every, long int n_decimate=0);
+  bool isDue(long int t) {return isDue(t, every, decimate);}
+  static bool isDue(long int t, long int n_every, long int n_decimate);
+  // Cutting the records after a time, e.g., for a run continued
+  //   from a checkpoint
+  static void truncateAfter(string file_name, bool is_binary, int n_column,
+			    double t_last);
+  // Appending records ($(n_column) values each)
+  void append(const double *values);
+  void flush(void); // hand the buffer to the background thread
+  bool sync(void);  // wait until the records are written and on the disk
+
+private:
+  FILE *out;
+  bool binary;
+  int n_column;
+  long int every, decimate;
+  vector<double> filling;
+  deque<vector<double> > full;
+  bool stopping, busy;
+  mutex lock;
+  condition_variable wake, drained;
+  thread writer;
+  void writerLoop(void);
+  void writeRecords(const vector<double> &buf);
+};
+
+
+#endif
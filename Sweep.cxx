@@ -0,0 +1,308 @@
+/* ============================================================
+   Main routine of the parameter sweep program, which runs the
+   model simulations of a grid of parameter values in parallel,
+   without the graphic display.
+   -----
+   Usage:
+      adapt-sweep input.txt sweep.txt output_file [n_threads]
+   -----
+      input.txt - text file of the base initial conditions and model
+                  parameters (same format as for adapt)
+      sweep.txt - text file of the parameters to sweep (see below)
+      output_file - all results are written to this file
+      n_threads - number of threads (default 0: one per hardware thread)
+   -----
+   Format of sweep.txt (one item per line):
+      <name> <value1> <value2> ...     a list of values
+      <name> <first>:<step>:<last>     a range of values
+      seeds <number of seeds per grid point> (default 1)
+      first_seed <seed of the first run> (default 1)
+      steps <number of time steps per run> (default 1000)
+      output_every <time steps between outputs> (default 100)
+      decimate <outputs after which output_every doubles> (default 0:
+               never; see isDue in Stats/StatsWriterC.cxx)
+      format <text, csv, or binary> (default text)
+   where <name> is any parameter of the model (AH, AG, sigmaH, 
+      sigmaG, kappa, alpha, gamma, welfare, enable_op, enable_net,
+      sync_net, fast_exp, event_driven, ut_epsilon, ut_verify,
+      ini_hlink_frac, dense_mb) or of the initial conditions (n_node,
+      immigrant_number, immigrant_ratio, initial_connections,
+      initial_opinions).
+   Every combination of the swept values (the Cartesian product) is
+      simulated once with every seed; seeds first_seed, first_seed+1,
+      ... are used at every grid point.
+   With the format csv or binary, output_file is written by a
+      statsWriter (see Stats/StatsWriterC.hpp), with the columns
+      point, seed, the swept parameters, time, and all fields of the
+      statistics (see getStatsNames in Stats/StatC.cxx).
+   -----
+   Subroutines:
+      read_sweep - reads the swept parameters from sweep.txt.
+      run_job - runs the simulation of one grid point and one seed.
+
+   Author: Yao-li Chuang
+   ============================================================ */
+#include "Main.H"
+#include "InitCond.H"
+#include "Parallel/ThreadPoolC.hpp"
+#include "Stats/StatsWriterC.hpp"
+
+// A swept parameter and its values
+struct sweepAxis {
+  string name;
+  vector<double> values;
+};
+
+// The settings of a sweep
+struct sweepSettings {
+  vector<struct sweepAxis> axes;
+  int n_seeds;
+  uint64_t first_seed;
+  long int n_steps;
+  long int output_every;
+  long int decimate;
+  string format;    // text, csv, or binary
+};
+
+// One simulation of the sweep
+struct sweepJob {
+  int point;              // index of the grid point
+  uint64_t seed;
+  vector<double> values;  // one value per axis
+};
+
+// Global variables shared by the jobs
+string base_file;                        // the base input file
+struct iniConditions base_conditions = { 500, 50, 0.1, 5, 1.0, "", 0, "", 0 };
+struct sweepSettings settings;
+ofstream output_file;
+mutex output_lock;
+statsWriter *stats_writer = NULL;        // the output of csv or binary
+
+/********************************************
+  Main routine 
+  -----
+  1. The base input file and the sweep file are read.
+  2. One job is made for every grid point and every seed.
+  3. The jobs run on a pool of threads; each job writes its results
+     to the output file as they are computed.
+ ********************************************/
+int main(int argc, char* argv[]) {
+  bool read_sweep(string);
+  void run_job(struct sweepJob);
+
+  if(argc < 4) {
+    cout << "Usage: " << argv[0] << " input.txt sweep.txt output_file [n_threads]" << endl;
+    return 1;
+  }
+  base_file.assign(argv[1]);
+  int n_threads = (argc > 4) ? atoi(argv[4]) : 0;
+  read_init_cond(base_file, base_conditions);
+  if(!read_sweep(string(argv[2])))
+    return 1;
+
+  if(settings.format.compare("text")==0) {
+    output_file.open(argv[3]);
+    if(!output_file.is_open()) {
+      cout << "Error in Sweep.cxx: unable to open " << argv[3] << endl;
+      return 1;
+    }
+    output_file << "#point\tseed";
+    for(size_t a=0; a<settings.axes.size(); a++)
+      output_file << '\t' << settings.axes[a].name;
+    output_file << "\ttime\t";
+    nodeList::writeStatsHeader(output_file);
+    output_file << '\n';
+  } else {
+    vector<string> columns;
+    columns.push_back("point");
+    columns.push_back("seed");
+    for(size_t a=0; a<settings.axes.size(); a++)
+      columns.push_back(settings.axes[a].name);
+    columns.push_back("time");
+    vector<string> names = nodeList::getStatsNames();
+    columns.insert(columns.end(), names.begin(), names.end());
+    stats_writer = new statsWriter(string(argv[3]), columns,
+				   settings.format.compare("binary")==0);
+  }
+
+  // Make the jobs: the Cartesian product of the axes, times the seeds
+  vector<struct sweepJob> jobs;
+  int n_axes = settings.axes.size();
+  vector<int> idx(n_axes, 0);
+  for(int point=0; ; point++) {
+    struct sweepJob job;
+    job.point = point;
+    for(int a=0; a<n_axes; a++)
+      job.values.push_back(settings.axes[a].values[idx[a]]);
+    for(int s=0; s<settings.n_seeds; s++) {
+      job.seed = settings.first_seed + s;
+      jobs.push_back(job);
+    }
+    // next grid point (the last axis changes fastest)
+    int a = n_axes-1;
+    for(; a>=0; a--) {
+      if(++idx[a] < static_cast<int>(settings.axes[a].values.size())) break;
+      idx[a] = 0;
+    }
+    if(a < 0) break;
+  }
+
+  threadPool pool(n_threads);
+  cout << "Running " << jobs.size() << " simulations on "
+       << pool.getNumThreads() << " threads" << endl;
+  taskGroup all_jobs;
+  for(size_t k=0; k<jobs.size(); k++)
+    pool.submit(bind(run_job, jobs[k]), all_jobs);
+  pool.wait(all_jobs);
+
+  if(stats_writer != NULL) delete stats_writer; // writing the remaining records
+  else output_file.close();
+  return 0;
+}
+
+/******************************************************************
+ This function reads the settings of the sweep.
+  Input ---
+     file_name: name of the sweep file
+  Return value ---
+     false if the file cannot be read or names an unknown parameter
+ ******************************************************************/
+bool read_sweep(string file_name) {
+  settings.n_seeds = 1;
+  settings.first_seed = 1;
+  settings.n_steps = 1000;
+  settings.output_every = 100;
+  settings.decimate = 0;
+  settings.format = "text";
+  ifstream input_file(file_name.data());
+  if(!input_file.is_open()) {
+    cout << "Error in read_sweep in Sweep.cxx: unable to open " << file_name.data() << endl;
+    return false;
+  }
+  string line;
+  while (getline(input_file, line)) {
+    stringstream line_stream(line);
+    string pname, item;
+    line_stream >> pname;
+    if(pname.length()==0 || pname[0]=='#') continue;
+    if(pname.compare("seeds")==0)
+      line_stream >> settings.n_seeds;
+    else if(pname.compare("first_seed")==0)
+      line_stream >> settings.first_seed;
+    else if(pname.compare("steps")==0)
+      line_stream >> settings.n_steps;
+    else if(pname.compare("output_every")==0)
+      line_stream >> settings.output_every;
+    else if(pname.compare("decimate")==0)
+      line_stream >> settings.decimate;
+    else if(pname.compare("format")==0) {
+      line_stream >> settings.format;
+      if(   settings.format.compare("text")!=0
+	 && settings.format.compare("csv")!=0
+	 && settings.format.compare("binary")!=0) {
+	cout << "Error in read_sweep in Sweep.cxx: unknown format " << settings.format << endl;
+	return false;
+      }
+    }
+    else {
+      if(   nodeList::isParameter(pname)==0
+	 && pname.compare("n_node")!=0
+	 && pname.compare("immigrant_number")!=0
+	 && pname.compare("immigrant_ratio")!=0
+	 && pname.compare("initial_connections")!=0
+	 && pname.compare("initial_opinions")!=0) {
+	cout << "Error in read_sweep in Sweep.cxx: no parameter called " << pname << endl;
+	return false;
+      }
+      struct sweepAxis axis;
+      axis.name = pname;
+      while(line_stream >> item) {
+	double first, step, last;
+	char c1, c2;
+	stringstream item_stream(item);
+	if((item_stream >> first >> c1 >> step >> c2 >> last)
+	   && c1==':' && c2==':' && step>0.0) { // a range of values
+	  for(int k=0; first+k*step <= last+1e-9*step; k++)
+	    axis.values.push_back(first+k*step);
+	} else                                // a single value
+	  axis.values.push_back(atof(item.data()));
+      }
+      if(axis.values.empty()) {
+	cout << "Error in read_sweep in Sweep.cxx: no values for " << pname << endl;
+	return false;
+      }
+      settings.axes.push_back(axis);
+    }
+  }
+  input_file.close();
+  if(settings.output_every <= 0) settings.output_every = settings.n_steps;
+  return true;
+}
+
+/******************************************************************
+ This subroutine runs the simulation of one job and writes its
+   results to the output file.
+  Input ---
+     job: the grid point and the seed to simulate
+ ******************************************************************/
+void run_job(struct sweepJob job) {
+  // Apply the values of the initial conditions
+  struct iniConditions ini = base_conditions;
+  int n_axes = settings.axes.size();
+  for(int a=0; a<n_axes; a++) {
+    string &pname = settings.axes[a].name;
+    double value = job.values[a];
+    if(pname.compare("n_node")==0)
+      ini.n_node = static_cast<int>(value);
+    else if(pname.compare("immigrant_number")==0)
+      ini.immigrant_number = static_cast<int>(value);
+    else if(pname.compare("immigrant_ratio")==0)
+      ini.immigrant_ratio = value;
+    else if(pname.compare("initial_connections")==0)
+      ini.initial_connections = static_cast<int>(value);
+    else if(pname.compare("initial_opinions")==0)
+      ini.initial_opinions = value;
+  }
+  nodeList *nlist = create_node_list(ini, job.seed);
+  // Apply the values of the model parameters
+  nlist->resetParametersFromFile(base_file, false);
+  for(int a=0; a<n_axes; a++) {
+    string &pname = settings.axes[a].name;
+    if(nodeList::isParameter(pname)==2)
+      nlist->changeParameter(pname, job.values[a] != 0.0);
+    else if(nodeList::isParameter(pname)==1)
+      nlist->changeParameter(pname, job.values[a]);
+  }
+
+  // Run the simulation; the results of each output time are
+  //   written at once so that lines of different jobs do not mix.
+  for(long int t=0; t<=settings.n_steps; t++) {
+    if(t > 0)
+      nlist->nextTimeStep();
+    if(!statsWriter::isDue(t, settings.output_every, settings.decimate)
+       && t != settings.n_steps) continue;
+    nlist->computeStats();
+    if(stats_writer != NULL) {
+      vector<double> values;
+      values.push_back(job.point);
+      values.push_back(static_cast<double>(job.seed));
+      values.insert(values.end(), job.values.begin(), job.values.end());
+      values.push_back(static_cast<double>(t));
+      nlist->getStatsValues(values);
+      stats_writer->append(values.data());
+    } else {
+      stringstream line;
+      line << job.point << '\t' << job.seed;
+      for(int a=0; a<n_axes; a++)
+	line << '\t' << job.values[a];
+      line << '\t' << t << '\t';
+      nlist->writeStats(line);
+      line << '\n';
+      lock_guard<mutex> guard(output_lock);
+      output_file << line.str();
+      output_file.flush();
+    } // end of if-else (stats_writer) statement
+  } // end of t loop
+  delete nlist;
+}